@@ -0,0 +1,125 @@
+/*
+Ranking of the three-prong candidates by a quality score.
+
+By default, the candidate search stops as soon as the maximum number of candidates is reached,
+so which candidates are kept depends on the order of the input tracks.
+Alternatively, all candidates can be ranked by a score (lower is better):
+- normChi2: normalized chi squared of the three-track vertex fit
+- massDiff: distance of the two-prong invariant mass to the resonance mass
+- pt: transverse momentum of the three-prong candidate (higher is better)
+and only the best ones are kept, using a bounded priority queue.
+Pairs and triplets whose best possible score can not beat the worst kept candidate
+are skipped before the (remaining) vertex fits; the ranking keeps count of them.
+*/
+
+#ifndef CandidateRanking_H
+#define CandidateRanking_H
+
+// system include files
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <vector>
+
+
+class CandidateRanking {
+  public:
+
+    // supported scores
+    // (note: First means no ranking, i.e. keep the first candidates that are found)
+    enum Score { First, NormChi2, MassDiff, Pt };
+
+  private:
+
+    // settings
+    Score theScore;
+    std::string theScoreName;
+
+    // counters
+    unsigned long theNPrunedPairs = 0;
+    unsigned long theNPrunedTriplets = 0;
+
+  public:
+    // constructor
+    // (note: the score is given by name, see above; throws an exception for unknown names)
+    CandidateRanking(const std::string& score);
+
+    // settings
+    Score score() const { return theScore; }
+    bool enabled() const { return theScore!=First; }
+
+    // counters
+    void countPrunedPair(){ theNPrunedPairs++; }
+    void countPrunedTriplet(){ theNPrunedTriplets++; }
+
+    // print a summary of the counters
+    void print(const std::string& name) const;
+};
+
+
+// bounded priority queue, keeping the entries with the lowest score
+// (note: for equal scores, the entry that was pushed first is kept,
+//  so that the result does not depend on anything else than the order of the input)
+template<class T> class BoundedPriorityQueue {
+  private:
+
+    struct Entry {
+        double score;
+        unsigned long order;
+        T value;
+        // (note: the worst entry is on top of the heap)
+        bool operator<(const Entry& other) const {
+            if( score!=other.score ) return score < other.score;
+            return order < other.order;
+        }
+    };
+
+    unsigned theCapacity = 0;
+    unsigned long theNPushed = 0;
+    std::vector<Entry> theHeap;
+
+  public:
+    // clear the queue and set the maximum number of entries
+    void reset(unsigned capacity){
+        theCapacity = capacity;
+        theNPushed = 0;
+        theHeap.clear();
+    }
+
+    bool full() const { return theHeap.size() >= theCapacity; }
+
+    // check if an entry with the given score (or any higher score) can not be kept anymore
+    bool rejects(double score) const {
+        if( !full() ) return false;
+        if( theHeap.empty() ) return true;
+        return score >= theHeap.front().score;
+    }
+
+    // add an entry, removing the worst one if the queue is full
+    void push(double score, const T& value){
+        if( rejects(score) ) return;
+        if( full() ){
+            std::pop_heap(theHeap.begin(), theHeap.end());
+            theHeap.pop_back();
+        }
+        theHeap.push_back({score, theNPushed++, value});
+        std::push_heap(theHeap.begin(), theHeap.end());
+    }
+
+    // add the kept entries of another queue
+    // (note: they are added best first, so that for equal scores their order is kept)
+    void merge(const BoundedPriorityQueue& other){
+        std::vector<Entry> entries(other.theHeap);
+        std::sort(entries.begin(), entries.end());
+        for(const Entry& entry : entries) push(entry.score, entry.value);
+    }
+
+    // append the kept entries to a vector, best first
+    void sorted(std::vector<T>& values) const {
+        std::vector<Entry> entries(theHeap);
+        std::sort(entries.begin(), entries.end());
+        for(const Entry& entry : entries) values.push_back(entry.value);
+    }
+};
+
+#endif
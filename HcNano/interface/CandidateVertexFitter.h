@@ -0,0 +1,112 @@
+/*
+Vertex fitting for the two- and three-track candidates in the charmed meson producers.
+
+Wraps the different vertex fitting options behind one interface:
+- the full Kalman vertex fit (default),
+- the lightweight fixed-size vertex fitter ("light"),
+- the incremental triplet fit, where the third track is added to the two-track vertex
+  with a single Kalman update instead of refitting all three tracks
+  (only available with the Kalman fitter).
+Optionally, the faster options are compared to the full Kalman fit on a sample of candidates,
+and a summary of the comparison is printed at the end of the job.
+
+The fits are done in batches: all two-track candidates collected in a stage of the producer
+are fitted in one call, and likewise for the three-track candidates,
+so that the fitting stage works on contiguous inputs and can be timed and tuned separately.
+*/
+
+#ifndef CandidateVertexFitter_H
+#define CandidateVertexFitter_H
+
+// system include files
+#include <limits>
+#include <string>
+#include <vector>
+
+// vertex fitter include files
+#include "RecoVertex/VertexPrimitives/interface/CachingVertex.h"
+#include "RecoVertex/VertexPrimitives/interface/TransientVertex.h"
+#include "RecoVertex/KalmanVertexFit/interface/KalmanVertexFitter.h"
+#include "TrackingTools/TransientTrack/interface/TransientTrack.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/TransientTrackCache.h"
+#include "PhysicsTools/HcNano/interface/LightVertexFitter.h"
+#include "PhysicsTools/HcNano/interface/IncrementalVertexFitter.h"
+#include "PhysicsTools/HcNano/interface/VertexFitComparison.h"
+
+
+class CandidateVertexFitter {
+  public:
+
+    // indices of the tracks of a two- or three-track candidate
+    // (note: for a triplet, pair is the index of the corresponding two-track candidate
+    //  in the last batch of pair fits, used as seed for the incremental triplet fit,
+    //  or noPair if the two-track vertex was not fitted here, e.g. when it is read from the event)
+    struct Pair { unsigned track1; unsigned track2; };
+    struct Triplet { unsigned pair; unsigned track1; unsigned track2; unsigned track3; };
+    static constexpr unsigned noPair = std::numeric_limits<unsigned>::max();
+
+  private:
+
+    // settings
+    bool theUseLightFitter;
+    bool theIncrementalTripletFit;
+
+    // fitters
+    const KalmanVertexFitter theKalmanFitter;
+    const LightVertexFitter theLightFitter;
+    const IncrementalVertexFitter theIncrementalFitter;
+
+    // two-track vertices of the last batch of pair fits
+    // (note: only kept with the Kalman fitter, as seed for the incremental triplet fit)
+    std::vector<CachingVertex<5>> thePairVertices;
+
+    // comparisons to the full Kalman fit
+    VertexFitComparison theIncrementalComparison;
+    VertexFitComparison theLightPairComparison;
+    VertexFitComparison theLightTripletComparison;
+
+    // fit a single two- or three-track vertex
+    TransientVertex fitPair(const reco::TransientTrack& track1,
+                            const reco::TransientTrack& track2,
+                            CachingVertex<5>& pairVertex);
+    TransientVertex fitTriplet(const reco::TransientTrack& track1,
+                               const reco::TransientTrack& track2,
+                               const reco::TransientTrack& track3,
+                               const CachingVertex<5>& pairVertex);
+
+  public:
+    // constructor
+    // (note: fitterType is either "kalman" or "light", otherwise an exception is thrown;
+    //  the intervals are the sampling intervals for the comparisons to the full Kalman fit
+    //  (0 disables the comparison), and maxNormChi2 is the vertex quality cut
+    //  used to compare the selection decisions)
+    CandidateVertexFitter(const std::string& fitterType,
+                          bool incrementalTripletFit,
+                          unsigned incrementalComparisonInterval,
+                          unsigned lightComparisonInterval,
+                          double maxNormChi2);
+
+    // fit a batch of two-track vertices
+    // (note: the vertices are aligned with the pairs)
+    void fitPairs(const std::vector<Pair>& pairs,
+                  TransientTrackCache& tracks,
+                  std::vector<TransientVertex>& vertices);
+
+    // fit a batch of three-track vertices
+    // (note: the vertices are aligned with the triplets,
+    //  the pair indices refer to the last batch of pair fits)
+    void fitTriplets(const std::vector<Triplet>& triplets,
+                     TransientTrackCache& tracks,
+                     std::vector<TransientVertex>& vertices);
+
+    // fit a single three-track vertex
+    // (note: used to stop fitting as soon as enough candidates are found)
+    TransientVertex fitTriplet(const Triplet& triplet, TransientTrackCache& tracks);
+
+    // print a summary of the comparisons
+    void print(const std::string& name) const;
+};
+
+#endif
@@ -0,0 +1,101 @@
+/*
+Cut-flow counters for the charmed meson producers.
+
+Counts the track pairs and triplets passing each stage of the candidate selection,
+separately for opposite-sign and same-sign track pairs,
+so that the rejection power of each cut can be studied without a dedicated module.
+The counters are accumulated per luminosity block and written to a table
+in the LuminosityBlocks tree, and are also summed over the job for a summary at the end.
+Counting is disabled by default, in which case it costs only a branch per stage.
+*/
+
+#ifndef CutFlow_H
+#define CutFlow_H
+
+// system include files
+#include <array>
+#include <memory>
+#include <string>
+
+// nanoaod include files
+#include "DataFormats/NanoAOD/interface/MergeableCounterTable.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/TrackKinematics.h"
+
+
+class CutFlow {
+  public:
+
+    // stages of the selection, in the order in which they are applied
+    // (note: the pair stages count track pairs, the triplet stages count pair + third track;
+    //  the same-sign split is always based on the two tracks of the pair)
+    enum Stage {
+        Pairs,              // all track pairs in the event
+        TwoTrackDeltaR,     // direction of both tracks
+        TrackPt,            // pt of both tracks
+        TwoTrackSep,        // separation of the reference points of both tracks
+        TwoProngMass,       // two-prong mass window (and daughter pt)
+        TwoTrackDCA,        // distance of closest approach of both tracks
+        TwoProngFit,        // two-track vertex fit
+        ThirdTrackDeltaR,   // direction of the third track
+        ThirdTrackPt,       // pt of the third track
+        ThirdTrackSep,      // separation of the third track and the two-prong vertex
+        ThreeProngMass,     // three-prong mass window
+        ThreeProngFit,      // three-track vertex fit
+        nStages
+    };
+    static const std::array<std::string, nStages> stageNames;
+
+  private:
+
+    // settings
+    bool theEnabled = false;
+
+    // counters for opposite-sign and same-sign pairs
+    // (note: the first ones are reset at the end of each luminosity block,
+    //  the second ones are kept over the whole job)
+    std::array<unsigned long long, nStages> theOS{};
+    std::array<unsigned long long, nStages> theSS{};
+    std::array<unsigned long long, nStages> theTotalOS{};
+    std::array<unsigned long long, nStages> theTotalSS{};
+
+  public:
+    // constructor
+    CutFlow(){}
+
+    // switch counting on or off
+    void enable(bool enabled){ theEnabled = enabled; }
+    bool enabled() const { return theEnabled; }
+
+    // count a pair or triplet passing a stage, given the two tracks of the pair
+    void count(Stage stage, const TrackKinematics& kinematics, unsigned i, unsigned j){
+        if( !theEnabled ) return;
+        if( kinematics.charge(i)*kinematics.charge(j) > 0 ) theSS[stage]++;
+        else theOS[stage]++;
+    }
+
+    // count all track pairs in the event, from the number of tracks of each charge
+    // (note: to be called once per event; the pairs are not looped over,
+    //  so the count does not depend on how the pairs are searched for)
+    void countPairs(const TrackKinematics& kinematics);
+
+    // add the counters of the current luminosity block of another instance
+    // (e.g. of a parallel chunk or another stream)
+    void add(const CutFlow& other);
+
+    // end the current luminosity block: add its counters to the ones over the whole job
+    // and reset them; or only reset them (e.g. after they were added to another instance)
+    void reset();
+    void clear();
+
+    // make a table with the counters of the current luminosity block
+    // (note: the column names are prefixed with the table name, as the
+    //  columns of all tables end up as separate branches in the LuminosityBlocks tree)
+    std::unique_ptr<nanoaod::MergeableCounterTable> makeTable(const std::string& name) const;
+
+    // print a summary of the counters over all luminosity blocks
+    void print(const std::string& name) const;
+};
+
+#endif
@@ -29,6 +29,9 @@ Custom analyzer class for investigating gen-level D* meson decays.
 
 // local include files
 #include "PhysicsTools/HcNano/interface/GenTools.h"
+#include "PhysicsTools/HcNano/interface/GenDecayChains.h"
+#include "PhysicsTools/HcNano/interface/GenEventIndex.h"
+#include "PhysicsTools/HcNano/interface/GenDecayMatcher.h"
 
 
 class DStarMesonGenProducer : public edm::stream::EDProducer<> {
@@ -41,18 +44,16 @@ class DStarMesonGenProducer : public edm::stream::EDProducer<> {
     void produce(edm::Event&, const edm::EventSetup&) override;
 
     // tokens
-    edm::EDGetTokenT<reco::GenParticleCollection> genParticlesToken;
+    edm::EDGetTokenT<GenEventIndex> genEventIndexToken;
+
+    // matcher for the gen-level decays
+    const GenDecayMatcher genDecayMatcher;
 
   public:
     // constructor, destructor, and other meta-functions
     explicit DStarMesonGenProducer(const edm::ParameterSet&);
     ~DStarMesonGenProducer() override;
     static void fillDescriptions(edm::ConfigurationDescriptions&);
-
-    // helper functions
-    static int find_DStar_decay_type(const std::vector<reco::GenParticle>&);
-    static std::vector< std::map< std::string, const reco::GenParticle* > > find_DStar_to_DZeroPi_to_KPiPi(
-      const std::vector<reco::GenParticle>&, const bool);
 };
 
 #endif
@@ -9,7 +9,9 @@ D* -> D0 pi -> K pi pi
 #define DStarMesonProducer_H
 
 // system include files
+#include <array>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 
 // root classes
@@ -17,20 +19,12 @@ D* -> D0 pi -> K pi pi
 
 // general include files
 #include "FWCore/Framework/interface/Frameworkfwd.h"
-#include "FWCore/Framework/interface/stream/EDProducer.h"
+#include "FWCore/Framework/interface/global/EDProducer.h"
 #include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/LuminosityBlock.h"
 #include "FWCore/Framework/interface/MakerMacros.h"
 #include "FWCore/ParameterSet/interface/ParameterSet.h"
 
-// vertex fitter include files
-#include "RecoVertex/VertexPrimitives/interface/TransientVertex.h"
-#include "MagneticField/Engine/interface/MagneticField.h"
-#include "MagneticField/ParametrizedEngine/src/OAEParametrizedMagneticField.h"
-#include "RecoVertex/KalmanVertexFit/interface/KalmanVertexFitter.h"
-#include "TrackingTools/TrajectoryState/interface/TrajectoryStateTransform.h"
-#include "TrackingTools/PatternTools/interface/TSCBLBuilderNoMaterial.h"
-#include "TrackingTools/PatternTools/interface/ClosestApproachInRPhi.h"
-
 // data format include files
 #include "DataFormats/PatCandidates/interface/PackedGenParticle.h"
 #include "DataFormats/PatCandidates/interface/PATObject.h"
@@ -47,43 +41,81 @@ D* -> D0 pi -> K pi pi
 
 // nanoaod include files
 #include "DataFormats/NanoAOD/interface/FlatTable.h"
+#include "DataFormats/NanoAOD/interface/MergeableCounterTable.h"
 
 // local include files
 #include "PhysicsTools/HcNano/interface/GenTools.h"
+#include "PhysicsTools/HcNano/interface/GenMatchMasks.h"
+#include "PhysicsTools/HcNano/interface/GenEventIndex.h"
+#include "PhysicsTools/HcNano/interface/SelectedTracks.h"
+#include "PhysicsTools/HcNano/interface/ThreeProngCandidateFinder.h"
+#include "PhysicsTools/HcNano/interface/CutFlow.h"
+#include "PhysicsTools/HcNano/interface/TwoProngCandidate.h"
 #include "PhysicsTools/HcNano/interface/DStarMesonGenProducer.h"
 
 
-class DStarMesonProducer : public edm::stream::EDProducer<> {
+class DStarMesonProducer : public edm::global::EDProducer<edm::StreamCache<ThreeProngCandidateFinder<DStarDecay>>,
+                                                          edm::LuminosityBlockSummaryCache<CutFlow>,
+                                                          edm::EndLuminosityBlockProducer> {
   private:
 
-    // constants
-    static constexpr double pimass = 0.13957;
-    static constexpr double pimass2 = pimass*pimass;
-    static constexpr double kmass = 0.493677;
-    static constexpr double kmass2 = kmass*kmass;
-    static constexpr double dzeromass = 1.86484;
-    static constexpr double dstarmass = 1.96847;
-
     // attributes and variables
     const std::string name;
     const std::string dtype;
-    const unsigned int nDStarMeson_max = 30;
+
+    // settings of the candidate finder
+    // (note: the candidate finder holds buffers, caches and counters,
+    //  so there is one per stream and the module itself has no mutable state,
+    //  apart from the stage timers of all streams combined for the summary at the end of the job)
+    const edm::ParameterSet finderConfig;
+    mutable std::mutex jobTimersMutex;
+    mutable StageTimers jobTimers;
+
+    // whether to write the cut-flow counters per luminosity block
+    const bool cutFlow;
 
     // template member functions
-    void produce(edm::Event&, const edm::EventSetup&) override;
+    std::unique_ptr<ThreeProngCandidateFinder<DStarDecay>> beginStream(edm::StreamID) const override;
+    void produce(edm::StreamID, edm::Event&, const edm::EventSetup&) const override;
+    void endStream(edm::StreamID) const override;
+    void endJob() override;
+    std::shared_ptr<CutFlow> globalBeginLuminosityBlockSummary(const edm::LuminosityBlock&,
+                                                               const edm::EventSetup&) const override;
+    void streamEndLuminosityBlockSummary(edm::StreamID, const edm::LuminosityBlock&,
+                                         const edm::EventSetup&, CutFlow*) const override;
+    void globalEndLuminosityBlockSummary(const edm::LuminosityBlock&,
+                                         const edm::EventSetup&, CutFlow*) const override;
+    void globalEndLuminosityBlockProduce(edm::LuminosityBlock&,
+                                         const edm::EventSetup&, const CutFlow*) const override;
 
     // helper functions
 
     // tokens
-    edm::EDGetTokenT<std::vector<pat::PackedCandidate>> packedPFCandidatesToken;
-    edm::EDGetTokenT<std::vector<pat::PackedCandidate>> lostTracksToken;
-    edm::EDGetTokenT<std::vector<reco::GenParticle>> genParticlesToken;
+    edm::EDGetTokenT<SelectedTracks> selectedTracksToken;
+    edm::EDGetTokenT<GenEventIndex> genEventIndexToken;
+    // (note: the two-prong candidates are optional,
+    //  if no input tag is given they are made by the candidate finder)
+    bool useTwoProngCandidates;
+    edm::EDGetTokenT<TwoProngCandidateCollection> twoProngCandidatesToken;
 
   public:
     // constructor, destructor, and other meta-functions
     explicit DStarMesonProducer(const edm::ParameterSet&);
     ~DStarMesonProducer() override;
     static void fillDescriptions(edm::ConfigurationDescriptions&);
+
+    // decay channel and maximum number of candidates
+    // (note: also used by the multi-channel producer)
+    typedef DStarDecay Decay;
+    static constexpr unsigned int maxCandidates = 30;
+
+    // make the output table from the candidates
+    // (note: gen-matching is only done if genEventIndex is not a null pointer)
+    static std::unique_ptr<nanoaod::FlatTable> makeTable(
+        const std::string& name,
+        const std::vector<ThreeProngCandidate>& candidates,
+        const SelectedTracks& selectedTracks,
+        const GenEventIndex* genEventIndex);
 };
 
 #endif
@@ -0,0 +1,65 @@
+/*
+Binned eta-phi grid for fast spatial lookup of tracks.
+
+Objects (identified by their index in the collection the grid was built from)
+are sorted into cells in the eta-phi plane.
+A query then returns only the objects in the cells that can contain objects
+within a given deltaR of a given direction,
+so that the exact deltaR check only needs to be done for those.
+
+The cells are at least as wide as the requested cell size,
+and the grid wraps around in phi.
+Objects outside of the eta range are put in the first or last eta cell.
+*/
+
+#ifndef EtaPhiGrid_H
+#define EtaPhiGrid_H
+
+// system include files
+#include <cstddef>
+#include <vector>
+
+
+class EtaPhiGrid {
+  private:
+
+    // grid definition
+    double theEtaMax = 0;
+    unsigned theNEta = 0;
+    unsigned theNPhi = 0;
+    double theEtaWidth = 0;
+    double thePhiWidth = 0;
+
+    // indices of the objects, sorted per cell,
+    // and offsets of the first object of each cell in this vector
+    // (note: theCellOffsets has one more element than the number of cells,
+    //  so that the objects in cell c are theIndices[theCellOffsets[c]:theCellOffsets[c+1]])
+    std::vector<unsigned> theIndices;
+    std::vector<unsigned> theCellOffsets;
+
+    // helper functions
+    int etaBin(double eta) const;
+    int phiBin(double phi) const;
+
+  public:
+    // constructors
+    EtaPhiGrid(){}
+    EtaPhiGrid(const std::vector<double>& etas,
+               const std::vector<double>& phis,
+               double cellSize,
+               double etaMax);
+
+    // find all objects that are possibly within a given deltaR of a given direction
+    // (note: the result is sorted by index, so looping over it preserves the order
+    //  of a plain loop over the full collection.
+    //  only objects with index >= minIndex are returned.)
+    void neighbours(double eta, double phi, double deltaR,
+                    std::vector<unsigned>& result,
+                    unsigned minIndex=0) const;
+
+    // access
+    size_t size() const { return theIndices.size(); }
+    unsigned nCells() const { return theNEta*theNPhi; }
+};
+
+#endif
@@ -0,0 +1,88 @@
+/*
+Per-event budget for the combinatorics of the charmed meson producers.
+
+Counts the track pairs tested and the vertex fits done in an event,
+and the time spent on it, and tells the candidate search to stop
+once one of them exceeds its configured maximum (a maximum of 0 means no limit).
+The event is then flagged as truncated, and only the candidates found so far are kept.
+The flag and the counters can be written to a singleton table,
+and the number of truncated events is counted for a summary at the end of the job.
+*/
+
+#ifndef EventBudget_H
+#define EventBudget_H
+
+// system include files
+#include <chrono>
+#include <memory>
+#include <string>
+
+// nanoaod include files
+#include "DataFormats/NanoAOD/interface/FlatTable.h"
+
+
+class EventBudget {
+  private:
+
+    // settings
+    unsigned long theMaxPairs;
+    unsigned long theMaxFits;
+    double theMaxTime;
+
+    // limits for the current event
+    // (note: smaller than the settings if the event is split into parallel chunks)
+    unsigned long theEventMaxPairs = 0;
+    unsigned long theEventMaxFits = 0;
+
+    // counters for the current event
+    unsigned long theNPairs = 0;
+    unsigned long theNFits = 0;
+    bool theTruncated = false;
+    std::chrono::steady_clock::time_point theStart;
+
+    // counters over all events
+    unsigned long theNEvents = 0;
+    unsigned long theNTruncatedEvents = 0;
+
+  public:
+    // constructor
+    EventBudget(unsigned long maxPairs, unsigned long maxFits, double maxTime);
+
+    // start a new event
+    // (note: the pair and fit limits are divided by nShares,
+    //  for events processed in several parallel chunks)
+    void start(unsigned nShares=1);
+
+    // count a tested pair or a number of vertex fits,
+    // returns false (and flags the event as truncated) if this exceeds the budget
+    bool countPair(){
+        theNPairs++;
+        if( theEventMaxPairs==0 || theNPairs<=theEventMaxPairs ) return true;
+        theTruncated = true;
+        return false;
+    }
+    bool countFits(unsigned long nFits);
+
+    // check the time budget,
+    // returns false (and flags the event as truncated) if it is exceeded
+    bool checkTime();
+
+    // state of the current event
+    bool truncated() const { return theTruncated; }
+    unsigned long nPairs() const { return theNPairs; }
+    unsigned long nFits() const { return theNFits; }
+
+    // add the counters of the current event of another budget (e.g. of a parallel chunk)
+    void add(const EventBudget& other);
+
+    // finish the current event and update the counters over all events
+    void finish();
+
+    // make a singleton table with the flag and counters of the current event
+    std::unique_ptr<nanoaod::FlatTable> makeTable(const std::string& name) const;
+
+    // print a summary of the counters over all events
+    void print(const std::string& name) const;
+};
+
+#endif
@@ -0,0 +1,52 @@
+/*
+Counter-based random numbers, seeded from the event identifier.
+
+Instead of drawing from a global generator (such as the C rand()),
+each random number is a hash of the run, luminosity block and event number
+and of a counter given by the caller (e.g. the indices of a track pair).
+The numbers are therefore the same for any number of threads or streams
+and for any order in which they are requested, and there is no shared state.
+The hash is the splitmix64 finalizer, which is cheap and well mixed.
+*/
+
+#ifndef EventRandom_H
+#define EventRandom_H
+
+// system include files
+#include <cstdint>
+
+// general include files
+#include "DataFormats/Provenance/interface/EventID.h"
+
+
+class EventRandom {
+  private:
+
+    // seed of this event
+    uint64_t theSeed;
+
+    // splitmix64 finalizer
+    static uint64_t mix(uint64_t x){
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+  public:
+    // constructor
+    explicit EventRandom(const edm::EventID& id)
+      : theSeed(mix(mix(mix(id.run()) ^ id.luminosityBlock()) ^ id.event())){}
+
+    // random 64-bit number for a given pair of counters
+    uint64_t get(uint64_t counter1, uint64_t counter2) const {
+        return mix(mix(theSeed ^ counter1) ^ counter2);
+    }
+
+    // random boolean for a given pair of counters
+    bool flip(uint64_t counter1, uint64_t counter2) const {
+        return (get(counter1, counter2) >> 63) != 0;
+    }
+};
+
+#endif
@@ -0,0 +1,157 @@
+/*
+Fixed-layout records of gen-level decay chains.
+
+Each chain policy lists the particles of one gen-level decay chain as an enum of roles,
+together with the names of the roles (used as prefixes of the output columns).
+A GenDecayChain holds one pointer per role into the gen particle collection,
+so finding a chain does not allocate anything beyond the output vector,
+and the particles of a chain are accessed by role instead of by name.
+The kinematics of a list of chains are written to a table by a single generic function
+that walks over the roles of the policy.
+
+Each policy also holds the decay descriptor of its chain (see GenDecayMatcher),
+written such that the particles of a match, numbered breadth-first, come in the order of the roles.
+For the H -> c cbar chains, the descriptor only covers the decay of the charmed meson,
+since the H -> c cbar -> meson step is not a mother-daughter relation in the gen record.
+The descriptors do not check the charges (each particle is a set of both charges),
+so that e.g. the doubly Cabibbo-suppressed D0 -> K+ pi- is also a D0 -> K pi decay,
+as in the original searches comparing the absolute pdg ids.
+(note: the kaons of the phi are matched by charge, to assign the KPlus and KMinus roles;
+ this is equivalent since the phi always decays to a K+ K- pair.)
+*/
+
+#ifndef GenDecayChains_H
+#define GenDecayChains_H
+
+// system include files
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+// data format include files
+#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+
+// nanoaod include files
+#include "DataFormats/NanoAOD/interface/FlatTable.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/GenEventIndex.h"
+#include "PhysicsTools/HcNano/interface/GenDecayMatcher.h"
+
+
+// D0 -> K pi
+struct DZeroGenDecay {
+    enum Role { DZero, K, Pi, nRoles };
+    static constexpr std::array<const char*, nRoles> roleNames = {{"DZero", "K", "Pi"}};
+    static constexpr const char* descriptor = "{D0 D~0} -> {K+ K-} {pi+ pi-}";
+};
+
+// D* -> D0 pi -> K pi pi
+struct DStarGenDecay {
+    enum Role { DStar, DZero, Pi1, K, Pi2, nRoles };
+    static constexpr std::array<const char*, nRoles> roleNames = {{"DStar", "DZero", "Pi1", "K", "Pi2"}};
+    static constexpr const char* descriptor = "{D*+ D*-} -> ({D0 D~0} -> {K+ K-} {pi+ pi-}) {pi+ pi-}";
+};
+
+// Ds -> phi pi -> K K pi
+struct DsGenDecay {
+    enum Role { Ds, Phi, Pi, KPlus, KMinus, nRoles };
+    static constexpr std::array<const char*, nRoles> roleNames = {{"Ds", "Phi", "Pi", "KPlus", "KMinus"}};
+    static constexpr const char* descriptor = "{D_s+ D_s-} -> (phi -> K+ K-) {pi+ pi-}";
+};
+
+// H -> c cbar -> D* X, D* -> D0 pi -> K pi pi
+struct HToDStarGenDecay {
+    enum Role { H, DStar, DZero, Pi1, K, Pi2, nRoles };
+    static constexpr std::array<const char*, nRoles> roleNames = {{"H", "DStar", "DZero", "Pi1", "K", "Pi2"}};
+    static constexpr const char* descriptor = "{D*+ D*-} -> ({D0 D~0} -> {K+ K-} {pi+ pi-}) {pi+ pi-}";
+};
+
+// H -> c cbar -> Ds X, Ds -> phi pi -> K K pi
+struct HToDsGenDecay {
+    enum Role { H, Ds, Phi, Pi, KPlus, KMinus, nRoles };
+    static constexpr std::array<const char*, nRoles> roleNames = {{"H", "Ds", "Phi", "Pi", "KPlus", "KMinus"}};
+    static constexpr const char* descriptor = "{D_s+ D_s-} -> (phi -> K+ K-) {pi+ pi-}";
+};
+
+// b-hadron -> D* X, D* -> D0 pi -> K pi pi
+struct BToDStarGenDecay {
+    enum Role { BHadron, DStar, DZero, Pi1, K, Pi2, nRoles };
+    static constexpr std::array<const char*, nRoles> roleNames = {{"BHadron", "DStar", "DZero", "Pi1", "K", "Pi2"}};
+    static constexpr const char* descriptor = "BHadron -> ({D*+ D*-} -> ({D0 D~0} -> {K+ K-} {pi+ pi-}) {pi+ pi-}) ...";
+};
+
+
+// one decay chain, i.e. one gen particle per role
+template<class Decay>
+class GenDecayChain {
+  private:
+    std::array<const reco::GenParticle*, Decay::nRoles> theParticles{};
+
+  public:
+    typedef typename Decay::Role Role;
+    static constexpr unsigned nRoles = Decay::nRoles;
+
+    // constructor
+    GenDecayChain(){}
+
+    // access
+    const reco::GenParticle*& operator[](Role role){ return theParticles[role]; }
+    const reco::GenParticle* operator[](Role role) const { return theParticles[role]; }
+    const reco::GenParticle* particle(unsigned role) const { return theParticles[role]; }
+};
+
+typedef GenDecayChain<DZeroGenDecay> DZeroGenChain;
+typedef GenDecayChain<DStarGenDecay> DStarGenChain;
+typedef GenDecayChain<DsGenDecay> DsGenChain;
+typedef GenDecayChain<HToDStarGenDecay> HToDStarGenChain;
+typedef GenDecayChain<HToDsGenDecay> HToDsGenChain;
+typedef GenDecayChain<BToDStarGenDecay> BToDStarGenChain;
+
+
+// make the decay chains from the matches of a descriptor
+// (note: the roles from firstRole onwards are set, in the order of the particles of each match)
+template<class Decay>
+std::vector<GenDecayChain<Decay>> makeGenDecayChains(
+        const GenEventIndex& genEventIndex,
+        const GenDecayMatcher::Matches& matches,
+        unsigned descriptor,
+        unsigned firstRole=0){
+    std::vector<GenDecayChain<Decay>> chains(matches.size(descriptor));
+    for(size_t idx=0; idx < chains.size(); idx++){
+        const unsigned* particles = matches.particles(descriptor, idx);
+        for(unsigned role=firstRole; role < Decay::nRoles; role++){
+            chains[idx][static_cast<typename Decay::Role>(role)] = &genEventIndex.particle(particles[role-firstRole]);
+        }
+    }
+    return chains;
+}
+
+
+// make a table with the pt, eta and phi of each particle in a list of decay chains
+// (note: the columns are named <role>_pt, <role>_eta and <role>_phi)
+template<class Decay>
+std::unique_ptr<nanoaod::FlatTable> makeGenDecayChainTable(
+        const std::string& name,
+        const std::vector<GenDecayChain<Decay>>& chains){
+    std::unique_ptr<nanoaod::FlatTable> table = std::make_unique<nanoaod::FlatTable>(chains.size(), name, false);
+    std::vector<float> pt(chains.size());
+    std::vector<float> eta(chains.size());
+    std::vector<float> phi(chains.size());
+    for(unsigned role=0; role < Decay::nRoles; role++){
+        for(size_t idx=0; idx < chains.size(); idx++){
+            const reco::GenParticle* particle = chains[idx].particle(role);
+            pt[idx] = particle->pt();
+            eta[idx] = particle->eta();
+            phi[idx] = particle->phi();
+        }
+        const std::string roleName(Decay::roleNames[role]);
+        table->addColumn<float>(roleName + "_pt", pt, "");
+        table->addColumn<float>(roleName + "_eta", eta, "");
+        table->addColumn<float>(roleName + "_phi", phi, "");
+    }
+    return table;
+}
+
+#endif
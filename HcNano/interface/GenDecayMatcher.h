@@ -0,0 +1,114 @@
+/*
+Matcher for gen-level decay chains, defined by decay descriptors.
+
+A decay descriptor is a short string describing a decay chain, e.g.
+  [D*+ -> (D0 -> K- pi+) pi+]cc
+with the following syntax:
+  - a particle is given by its name (e.g. D*+, K-, pi+, D_s+, H, c~),
+    by a set of alternative names in curly brackets (e.g. {D+ D0 D_s+}),
+    or by one of the hadron classes CharmHadron and BHadron (matching both charges);
+  - a decay is written as "mother -> daughters", where a daughter that is itself required
+    to decay in a given way is written as a decay in parentheses;
+  - a decay is exclusive (the mother has exactly the listed daughters, in any order),
+    unless the list of daughters ends with "...", in which case other daughters are allowed;
+  - a particle without "->" may decay in any way;
+  - enclosing the descriptor in square brackets followed by "cc"
+    also matches the charge conjugate decay chain
+    (decays of self-conjugate particles, e.g. phi -> K+ K-, are left as they are,
+    so that each particle keeps its role).
+
+The descriptors are compiled once, when the matcher is constructed,
+and all of them are matched in a single loop over a given list of candidate mother particles
+(e.g. the particles from the hard scattering), using the daughters stored in the GenEventIndex.
+For each mother particle and descriptor, at most one match is kept.
+The particles of a match are numbered breadth-first, i.e. the mother first,
+then its daughters in the order of the descriptor, then the daughters of the first daughter, etc.
+For example, for the descriptor above: D*, D0, pi (from the D*), K, pi (from the D0).
+*/
+
+#ifndef GenDecayMatcher_H
+#define GenDecayMatcher_H
+
+// system include files
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// local include files
+#include "PhysicsTools/HcNano/interface/GenEventIndex.h"
+
+
+class GenDecayMatcher {
+  public:
+
+    // matches of all descriptors in an event
+    class Matches {
+      friend class GenDecayMatcher;
+      private:
+        // per descriptor: number of particles per match and the particles of all matches
+        std::vector<unsigned> theNParticles;
+        std::vector<std::vector<unsigned>> theParticles;
+      public:
+        size_t size(unsigned descriptor) const {
+            return theParticles[descriptor].size()/theNParticles[descriptor];
+        }
+        // indices of the gen particles of a match, numbered breadth-first
+        const unsigned* particles(unsigned descriptor, size_t match) const {
+            return theParticles[descriptor].data() + match*theNParticles[descriptor];
+        }
+        // first descriptor with at least one match (-1 if none)
+        int first() const;
+    };
+
+  private:
+
+    // particle in a compiled descriptor
+    // (note: the daughters of a node are the nodes firstDaughter up to firstDaughter+nDaughters,
+    //  since the nodes are stored breadth-first)
+    struct Node {
+        std::vector<int> pdgIds;
+        int hadronClass = 0;
+        bool decays = false;
+        bool inclusive = false;
+        unsigned firstDaughter = 0;
+        unsigned nDaughters = 0;
+    };
+
+    // compiled descriptor, or its charge conjugate
+    struct Variant {
+        unsigned descriptor;
+        std::vector<Node> nodes;
+    };
+
+    // settings
+    std::vector<std::string> theDescriptors;
+    std::vector<unsigned> theNParticles;
+    std::vector<Variant> theVariants;
+
+    // variants by pdg id of their mother,
+    // and variants with a hadron class as mother (to be tried for all particles)
+    std::unordered_map<int, std::vector<unsigned>> theVariantsByPdgId;
+    std::vector<unsigned> theClassVariants;
+
+    // matching
+    static bool accepts(const Node&, int pdgId);
+    static bool matchNode(const std::vector<Node>&, unsigned node, unsigned particle,
+                          const GenEventIndex&, unsigned* result);
+    static bool matchDaughters(const std::vector<Node>&, unsigned node, unsigned daughter,
+                               GenEventIndex::IndexRange, const GenEventIndex&, unsigned* result);
+
+  public:
+    // constructor
+    // (note: throws an exception if a descriptor cannot be parsed)
+    explicit GenDecayMatcher(const std::vector<std::string>& descriptors);
+
+    // access
+    size_t size() const { return theDescriptors.size(); }
+    const std::string& descriptor(unsigned i) const { return theDescriptors[i]; }
+    unsigned nParticles(unsigned i) const { return theNParticles[i]; }
+
+    // match all descriptors, with any of the given particles as mother
+    void match(const GenEventIndex&, const std::vector<unsigned>& mothers, Matches&) const;
+};
+
+#endif
@@ -0,0 +1,88 @@
+/*
+Event product holding an index of the gen particle record.
+
+The index is built once per event by the GenEventIndexProducer,
+in a single pass over the gen particles, and is consumed by all gen-level producers
+and by the gen-matching of the charmed meson producers, instead of each of them
+walking the gen record (and the mother chains of all particles) separately.
+For each gen particle, it holds whether it is the last copy,
+the index and pdg id of its mother (skipping copies of the particle itself,
+as in GenTools::getMother), and the indices of its daughters.
+It also holds the list of all last copies and the list of particles from the hard scattering,
+implemented (as before in each producer separately) as last copies having a proton as their mother.
+
+The gen particles themselves are not copied: only a pointer to the collection in the event is kept,
+so this product is only valid within the event it was made in and is not meant to be written out.
+*/
+
+#ifndef GenEventIndex_H
+#define GenEventIndex_H
+
+// system include files
+#include <cstdlib>
+#include <vector>
+
+// data format include files
+#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+
+
+class GenEventIndex {
+  public:
+
+    // range of indices, e.g. the daughters of a particle
+    class IndexRange {
+      private:
+        const unsigned* theBegin;
+        const unsigned* theEnd;
+      public:
+        IndexRange(const unsigned* begin, const unsigned* end) : theBegin(begin), theEnd(end){}
+        const unsigned* begin() const { return theBegin; }
+        const unsigned* end() const { return theEnd; }
+        size_t size() const { return theEnd - theBegin; }
+        unsigned operator[](size_t i) const { return theBegin[i]; }
+    };
+
+  private:
+
+    // gen particles (owned by the event)
+    const std::vector<reco::GenParticle>* theParticles = nullptr;
+
+    // per particle: last copy flag, mother index (-1 if none) and mother pdg id (0 if none)
+    std::vector<bool> theLastCopy;
+    std::vector<int> theMotherIndices;
+    std::vector<int> theMotherPdgIds;
+
+    // daughters of all particles
+    // (note: the daughters of particle i are theDaughters[theDaughterOffsets[i] : theDaughterOffsets[i+1]])
+    std::vector<unsigned> theDaughterOffsets;
+    std::vector<unsigned> theDaughters;
+
+    // indices of all last copies and of the particles from the hard scattering
+    std::vector<unsigned> theLastCopies;
+    std::vector<unsigned> theHardScatter;
+
+  public:
+    // constructor
+    GenEventIndex(){}
+    explicit GenEventIndex(const std::vector<reco::GenParticle>& particles);
+
+    // access to the particles
+    size_t size() const { return theMotherIndices.size(); }
+    const std::vector<reco::GenParticle>& particles() const { return *theParticles; }
+    const reco::GenParticle& particle(size_t i) const { return (*theParticles)[i]; }
+    size_t index(const reco::GenParticle& particle) const { return &particle - theParticles->data(); }
+
+    // access to the index
+    bool isLastCopy(size_t i) const { return theLastCopy[i]; }
+    int motherIndex(size_t i) const { return theMotherIndices[i]; }
+    int motherPdgId(size_t i) const { return theMotherPdgIds[i]; }
+    bool isHardScatter(size_t i) const { return theLastCopy[i] && std::abs(theMotherPdgIds[i])==2212; }
+    IndexRange daughters(size_t i) const {
+        return IndexRange(theDaughters.data() + theDaughterOffsets[i],
+                          theDaughters.data() + theDaughterOffsets[i+1]);
+    }
+    const std::vector<unsigned>& lastCopies() const { return theLastCopies; }
+    const std::vector<unsigned>& hardScatter() const { return theHardScatter; }
+};
+
+#endif
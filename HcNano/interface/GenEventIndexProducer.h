@@ -0,0 +1,45 @@
+/*
+Custom producer class for indexing the gen particle record.
+
+The mother chains, daughters and hard scattering particles of the gen particles
+are found once per event and stored in a GenEventIndex product,
+which is shared by all gen-level producers and by the gen-matching of the charmed meson producers.
+*/
+
+#ifndef GenEventIndexProducer_H
+#define GenEventIndexProducer_H
+
+// system include files
+#include <memory>
+
+// general include files
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/global/EDProducer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+// data format include files
+#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/GenEventIndex.h"
+
+
+class GenEventIndexProducer : public edm::global::EDProducer<> {
+  private:
+
+    // template member functions
+    void produce(edm::StreamID, edm::Event&, const edm::EventSetup&) const override;
+
+    // tokens
+    edm::EDGetTokenT<std::vector<reco::GenParticle>> genParticlesToken;
+
+  public:
+    // constructor, destructor, and other meta-functions
+    explicit GenEventIndexProducer(const edm::ParameterSet&);
+    ~GenEventIndexProducer() override;
+    static void fillDescriptions(edm::ConfigurationDescriptions&);
+};
+
+#endif
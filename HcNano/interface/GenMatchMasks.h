@@ -0,0 +1,99 @@
+/*
+Per-event gen-match bitmasks of the selected tracks.
+
+For a list of gen-level decay chains, each with a fixed set of roles (e.g. the K and the pions
+of a D* -> D0 pi -> K pi pi decay), the selected tracks that are geometrically matched
+to the gen particle of a given chain and role are found once per event,
+using the eta-phi grid of the selected tracks.
+For each track and role, the chains it matches are stored as a bitmask (one bit per chain),
+so that matching a candidate to the gen chains only takes a few bitwise operations
+on the masks of its tracks, instead of a deltaR computation per track, chain and role.
+Chains can also be flagged (e.g. as coming from the hard scattering),
+so that a match can be restricted to a subset of the chains.
+
+For events with more than 64 chains, the masks span several words,
+and the matching condition is evaluated for each word separately.
+*/
+
+#ifndef GenMatchMasks_H
+#define GenMatchMasks_H
+
+// system include files
+#include <cstdint>
+#include <vector>
+
+// data format include files
+#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/SelectedTracks.h"
+
+
+class GenMatchMasks {
+  public:
+
+    typedef uint64_t Word;
+    static constexpr unsigned wordSize = 64;
+
+    // masks of one word, as seen by a matching condition
+    class View {
+      private:
+        const GenMatchMasks& theMasks;
+        unsigned theWord;
+      public:
+        View(const GenMatchMasks& masks, unsigned word) : theMasks(masks), theWord(word){}
+        // chains matched by a track in a given role
+        Word mask(unsigned track, unsigned role) const {
+            return theMasks.theMasks[(track*theMasks.theNRoles + role)*theMasks.theNWords + theWord];
+        }
+        // chains with a given flag
+        Word flag(unsigned flag) const {
+            return theMasks.theFlags[flag*theMasks.theNWords + theWord];
+        }
+    };
+
+  private:
+
+    // settings
+    unsigned theNRoles = 0;
+    unsigned theNFlags = 0;
+    unsigned theNWords = 0;
+    double theDeltaR = 0;
+
+    // tracks
+    const SelectedTracks* theTracks = nullptr;
+
+    // masks per track and role, and per flag
+    // (note: the mask of track t and role r is theMasks[(t*nRoles + r)*nWords : (t*nRoles + r + 1)*nWords])
+    std::vector<Word> theMasks;
+    std::vector<Word> theFlags;
+
+    // buffer for the grid lookup
+    std::vector<unsigned> theNeighbours;
+
+  public:
+    // constructor
+    GenMatchMasks(){}
+
+    // clear the masks and set the tracks and number of chains for a new event
+    // (note: a track matches a gen particle if their deltaR is below the given threshold)
+    void reset(const SelectedTracks& tracks, unsigned nChains, unsigned nRoles, unsigned nFlags, double deltaR);
+
+    // set the gen particle of a given chain and role, and flag a chain
+    void setParticle(unsigned chain, unsigned role, const reco::GenParticle& particle);
+    void setFlag(unsigned chain, unsigned flag){
+        theFlags[flag*theNWords + chain/wordSize] |= (Word(1) << (chain%wordSize));
+    }
+
+    // check whether a matching condition is fulfilled for at least one chain
+    // (note: the condition is a function of a View returning a Word,
+    //  and is fulfilled for the chains with a bit set in the result)
+    template<class F> bool any(F&& condition) const {
+        for(unsigned w=0; w<theNWords; w++){
+            if( condition(View(*this, w)) ) return true;
+        }
+        return false;
+    }
+};
+
+#endif
@@ -27,6 +27,7 @@ For testing and debugging, not meant to be used in production.
 
 // local include files
 #include "PhysicsTools/HcNano/interface/GenTools.h"
+#include "PhysicsTools/HcNano/interface/GenEventIndex.h"
 
 
 class GenParticlePrinter : public edm::stream::EDProducer<> {
@@ -39,7 +40,7 @@ class GenParticlePrinter : public edm::stream::EDProducer<> {
     void produce(edm::Event&, const edm::EventSetup&) override;
 
     // tokens
-    edm::EDGetTokenT<reco::GenParticleCollection> genParticlesToken;
+    edm::EDGetTokenT<GenEventIndex> genEventIndexToken;
 
   public:
     // constructor, destructor, and other meta-functions
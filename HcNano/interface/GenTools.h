@@ -26,10 +26,11 @@ namespace GenTools{
     int getMotherPdgId(const reco::GenParticle&, const std::vector<reco::GenParticle>&);
 
     // find daughter particles
-    std::vector<reco::GenParticle> getQuarkDaughters(
+    // (note: the daughters are pointers into the gen particle collection)
+    std::vector<const reco::GenParticle*> getQuarkDaughters(
         const reco::GenParticle&,
         const std::vector<reco::GenParticle>&);
-    std::vector<reco::GenParticle> getQuarkPairDaughters(
+    std::vector<const reco::GenParticle*> getQuarkPairDaughters(
         const reco::GenParticle&,
         const reco::GenParticle&,
         const std::vector<reco::GenParticle>&);
@@ -29,6 +29,9 @@ Custom analyzer class for investigating gen-level H -> D* + X decays.
 
 // local include files
 #include "PhysicsTools/HcNano/interface/GenTools.h"
+#include "PhysicsTools/HcNano/interface/GenDecayChains.h"
+#include "PhysicsTools/HcNano/interface/GenEventIndex.h"
+#include "PhysicsTools/HcNano/interface/GenDecayMatcher.h"
 
 
 class HToDStarMesonGenProducer : public edm::stream::EDProducer<> {
@@ -41,7 +44,10 @@ class HToDStarMesonGenProducer : public edm::stream::EDProducer<> {
     void produce(edm::Event&, const edm::EventSetup&) override;
 
     // tokens
-    edm::EDGetTokenT<reco::GenParticleCollection> genParticlesToken;
+    edm::EDGetTokenT<GenEventIndex> genEventIndexToken;
+
+    // matcher for the gen-level decays
+    const GenDecayMatcher genDecayMatcher;
 
   public:
     // constructor, destructor, and other meta-functions
@@ -50,9 +56,8 @@ class HToDStarMesonGenProducer : public edm::stream::EDProducer<> {
     static void fillDescriptions(edm::ConfigurationDescriptions&);
 
     // helper functions
-    static int find_H_decay_type(const std::vector<reco::GenParticle>&);
-    static std::vector< std::map< std::string, const reco::GenParticle* > > find_H_to_DStar_to_DZeroPi_to_KPiPi(
-      const std::vector<reco::GenParticle>&);
+    static int find_H_decays(const GenEventIndex&, const GenDecayMatcher&,
+      std::vector<HToDStarGenChain>&);
 };
 
 #endif
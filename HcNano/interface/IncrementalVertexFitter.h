@@ -0,0 +1,41 @@
+/*
+Incremental vertex fit for adding one track to an already fitted vertex.
+
+Instead of refitting all tracks from scratch, the new track is linearized
+around the position of the existing vertex and added to it with a single Kalman update.
+The tracks that were already part of the vertex are not re-linearized,
+so the result can differ slightly from a full refit;
+the VertexFitComparison class can be used to compare both on a sample of candidates.
+*/
+
+#ifndef IncrementalVertexFitter_H
+#define IncrementalVertexFitter_H
+
+// vertex fitter include files
+#include "RecoVertex/VertexPrimitives/interface/CachingVertex.h"
+#include "RecoVertex/VertexPrimitives/interface/TransientVertex.h"
+#include "RecoVertex/KalmanVertexFit/interface/KalmanVertexUpdator.h"
+#include "RecoVertex/VertexTools/interface/LinearizedTrackStateFactory.h"
+#include "RecoVertex/VertexTools/interface/VertexTrackFactory.h"
+#include "TrackingTools/TransientTrack/interface/TransientTrack.h"
+
+
+class IncrementalVertexFitter {
+  private:
+
+    // linearization, vertex track and update tools
+    LinearizedTrackStateFactory theLinearizer;
+    VertexTrackFactory<5> theVertexTrackFactory;
+    KalmanVertexUpdator<5> theUpdator;
+
+  public:
+    // constructor
+    IncrementalVertexFitter(){}
+
+    // add a track to a fitted vertex
+    // (note: the input vertex must be valid)
+    CachingVertex<5> addTrack(const CachingVertex<5>& vertex,
+                              const reco::TransientTrack& track) const;
+};
+
+#endif
@@ -0,0 +1,60 @@
+/*
+Lightweight vertex fitter for a fixed, small number of tracks (two or three).
+
+Each track is approximated as a straight line through its point of closest approach
+to the current vertex estimate, along its momentum direction at that point.
+The vertex is the point that minimizes the sum of the squared distances to these lines,
+weighted with the transverse and longitudinal impact parameter uncertainties of each track.
+This is a linear problem, solved with fixed-size 3x3 matrices,
+and the procedure is iterated a few times, each time re-evaluating the tracks
+at the new vertex estimate.
+
+The correlations between the impact parameters and the other track parameters are neglected,
+so the result is an approximation of the full Kalman vertex fit;
+the VertexFitComparison class can be used to compare both on a sample of candidates.
+The returned vertex contains the position, its covariance, the chi2 and the number of degrees
+of freedom (2*N-3), but no refitted tracks.
+*/
+
+#ifndef LightVertexFitter_H
+#define LightVertexFitter_H
+
+// system include files
+#include <array>
+
+// vertex fitter include files
+#include "RecoVertex/VertexPrimitives/interface/TransientVertex.h"
+#include "TrackingTools/TransientTrack/interface/TransientTrack.h"
+
+
+class LightVertexFitter {
+  private:
+
+    // settings
+    unsigned theMaxIterations;
+    double theMaxShift;
+
+  public:
+    // constructor
+    // (note: the iteration stops after maxIterations iterations
+    //  or when the vertex moves by less than maxShift (in cm))
+    LightVertexFitter(unsigned maxIterations=3, double maxShift=1e-4);
+
+    // fit a vertex
+    // (note: only implemented for N=2 and N=3)
+    template<unsigned N> TransientVertex vertex(
+        const std::array<const reco::TransientTrack*, N>& tracks) const;
+
+    // convenience functions for two and three tracks
+    TransientVertex vertex(const reco::TransientTrack& track1,
+                           const reco::TransientTrack& track2) const {
+        return vertex<2>({{&track1, &track2}});
+    }
+    TransientVertex vertex(const reco::TransientTrack& track1,
+                           const reco::TransientTrack& track2,
+                           const reco::TransientTrack& track3) const {
+        return vertex<3>({{&track1, &track2, &track3}});
+    }
+};
+
+#endif
@@ -0,0 +1,113 @@
+/*
+Custom analyzer class for finding charmed mesons in several decay channels at once.
+
+Runs a single loop over track pairs for all channels
+(see ThreeProngCandidateFinder.h for which steps are shared between the channels),
+and makes the same output tables as the corresponding single-channel producers,
+with one table per channel.
+
+The channels are given by the single-channel producers,
+which provide the decay policy, the maximum number of candidates and the output table;
+the plugins defined in the corresponding source file are:
+- DStarDsMesonProducer: D* -> D0 pi -> K pi pi and Ds -> phi pi -> K K pi
+- HToDStarDsMesonProducer: the same, with the cuts of the H -> D* and H -> Ds producers
+*/
+
+#ifndef MultiChannelMesonProducer_H
+#define MultiChannelMesonProducer_H
+
+// system include files
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// general include files
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/global/EDProducer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/LuminosityBlock.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+// data format include files
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/HepMCCandidate/interface/GenParticle.h"
+
+// nanoaod include files
+#include "DataFormats/NanoAOD/interface/FlatTable.h"
+#include "DataFormats/NanoAOD/interface/MergeableCounterTable.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/SelectedTracks.h"
+#include "PhysicsTools/HcNano/interface/GenEventIndex.h"
+#include "PhysicsTools/HcNano/interface/ThreeProngCandidateFinder.h"
+#include "PhysicsTools/HcNano/interface/CutFlow.h"
+
+
+template<class... Producers>
+class MultiChannelMesonProducer
+  : public edm::global::EDProducer<edm::StreamCache<ThreeProngCandidateFinder<typename Producers::Decay...>>,
+                                   edm::LuminosityBlockSummaryCache<std::array<CutFlow, sizeof...(Producers)>>,
+                                   edm::EndLuminosityBlockProducer> {
+  private:
+
+    // number of channels
+    static constexpr size_t nChannels = sizeof...(Producers);
+
+    // cut-flow counters of all channels
+    typedef std::array<CutFlow, nChannels> CutFlows;
+
+    // attributes and variables
+    // (note: names are the names of the output tables, one per channel)
+    const std::vector<std::string> names;
+    const std::string dtype;
+
+    // settings of the candidate finder
+    // (note: the candidate finder holds buffers, caches and counters,
+    //  so there is one per stream and the module itself has no mutable state,
+    //  apart from the stage timers of all streams combined for the summary at the end of the job)
+    const edm::ParameterSet finderConfig;
+    mutable std::mutex jobTimersMutex;
+    mutable StageTimers jobTimers;
+
+    // whether to write the cut-flow counters per luminosity block
+    const bool cutFlow;
+
+    // template member functions
+    std::unique_ptr<ThreeProngCandidateFinder<typename Producers::Decay...>>
+        beginStream(edm::StreamID) const override;
+    void produce(edm::StreamID, edm::Event&, const edm::EventSetup&) const override;
+    void endStream(edm::StreamID) const override;
+    void endJob() override;
+    std::shared_ptr<CutFlows> globalBeginLuminosityBlockSummary(const edm::LuminosityBlock&,
+                                                                const edm::EventSetup&) const override;
+    void streamEndLuminosityBlockSummary(edm::StreamID, const edm::LuminosityBlock&,
+                                         const edm::EventSetup&, CutFlows*) const override;
+    void globalEndLuminosityBlockSummary(const edm::LuminosityBlock&,
+                                         const edm::EventSetup&, CutFlows*) const override;
+    void globalEndLuminosityBlockProduce(edm::LuminosityBlock&,
+                                         const edm::EventSetup&, const CutFlows*) const override;
+
+    // helper functions
+    template<size_t... K> void putTables(
+        edm::Event& iEvent,
+        const std::array<std::vector<ThreeProngCandidate>, nChannels>& candidates,
+        const SelectedTracks& selectedTracks,
+        const GenEventIndex* genEventIndex,
+        std::index_sequence<K...>) const;
+
+    // tokens
+    edm::EDGetTokenT<SelectedTracks> selectedTracksToken;
+    edm::EDGetTokenT<GenEventIndex> genEventIndexToken;
+
+  public:
+    // constructor, destructor, and other meta-functions
+    explicit MultiChannelMesonProducer(const edm::ParameterSet&);
+    ~MultiChannelMesonProducer() override;
+    static void fillDescriptions(edm::ConfigurationDescriptions&);
+};
+
+#endif
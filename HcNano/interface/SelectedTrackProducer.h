@@ -0,0 +1,57 @@
+/*
+Custom producer class for preselecting tracks for charmed meson reconstruction.
+
+The packed PF candidates and lost tracks are merged,
+and the tracks passing the preselection are stored in a SelectedTracks product.
+This is done only once per event, and the product is shared by all charmed meson producers.
+*/
+
+#ifndef SelectedTrackProducer_H
+#define SelectedTrackProducer_H
+
+// system include files
+#include <memory>
+
+// general include files
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/global/EDProducer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+// data format include files
+#include "DataFormats/PatCandidates/interface/PackedCandidate.h"
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/TrackReco/interface/TrackBase.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/SelectedTracks.h"
+
+
+class SelectedTrackProducer : public edm::global::EDProducer<> {
+  private:
+
+    // attributes and variables
+    const double minPt;
+    const reco::TrackBase::TrackQuality quality;
+    const double gridCellSize;
+    const double gridEtaMax;
+
+    // template member functions
+    void produce(edm::StreamID, edm::Event&, const edm::EventSetup&) const override;
+
+    // helper functions
+    void addTracks(const edm::Handle<std::vector<pat::PackedCandidate>>&, SelectedTracks&) const;
+
+    // tokens
+    edm::EDGetTokenT<std::vector<pat::PackedCandidate>> packedPFCandidatesToken;
+    edm::EDGetTokenT<std::vector<pat::PackedCandidate>> lostTracksToken;
+
+  public:
+    // constructor, destructor, and other meta-functions
+    explicit SelectedTrackProducer(const edm::ParameterSet&);
+    ~SelectedTrackProducer() override;
+    static void fillDescriptions(edm::ConfigurationDescriptions&);
+};
+
+#endif
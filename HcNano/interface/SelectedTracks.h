@@ -0,0 +1,75 @@
+/*
+Event product holding the preselected tracks used for charmed meson reconstruction.
+
+The tracks are built once per event by the SelectedTrackProducer
+from the packed PF candidates and lost tracks,
+and are consumed by all the charmed meson producers.
+For each track, a pointer to the packed candidate it was taken from is kept as well,
+together with an eta-phi grid of the tracks for fast lookup of nearby tracks
+and a structure-of-arrays copy of their kinematics for the cheap selections.
+
+The tracks themselves are not copied: only pointers to the pseudo-tracks
+owned by the packed candidates in the event are stored,
+so this product is only valid within the event it was made in and is not meant to be written out.
+*/
+
+#ifndef SelectedTracks_H
+#define SelectedTracks_H
+
+// system include files
+#include <vector>
+
+// data format include files
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/Candidate/interface/Candidate.h"
+#include "DataFormats/Candidate/interface/CandidateFwd.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/EtaPhiGrid.h"
+#include "PhysicsTools/HcNano/interface/TrackKinematics.h"
+
+
+class SelectedTracks {
+  private:
+
+    // tracks and corresponding packed candidates
+    // (note: both vectors are aligned, i.e. candidates[i] is the source of tracks[i];
+    //  the tracks are owned by the packed candidates in the event)
+    std::vector<const reco::Track*> theTracks;
+    std::vector<reco::CandidatePtr> theCandidates;
+
+    // kinematics of the tracks (aligned with the tracks)
+    TrackKinematics theKinematics;
+
+    // eta-phi grid of the tracks
+    EtaPhiGrid theGrid;
+
+  public:
+    // constructor
+    SelectedTracks(){}
+
+    // add a track and the packed candidate it was taken from
+    void push_back(const reco::Track* track, const reco::CandidatePtr& candidate){
+        theTracks.push_back(track);
+        theCandidates.push_back(candidate);
+        theKinematics.push_back(*track);
+    }
+    void reserve(size_t n){
+        theTracks.reserve(n);
+        theCandidates.reserve(n);
+        theKinematics.reserve(n);
+    }
+
+    // set the eta-phi grid (to be done after all tracks have been added)
+    void setGrid(EtaPhiGrid grid){ theGrid = std::move(grid); }
+
+    // access
+    size_t size() const { return theTracks.size(); }
+    const std::vector<const reco::Track*>& tracks() const { return theTracks; }
+    const reco::Track& track(size_t i) const { return *theTracks[i]; }
+    const reco::CandidatePtr& candidate(size_t i) const { return theCandidates[i]; }
+    const TrackKinematics& kinematics() const { return theKinematics; }
+    const EtaPhiGrid& grid() const { return theGrid; }
+};
+
+#endif
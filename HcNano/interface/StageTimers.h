@@ -0,0 +1,113 @@
+/*
+Per-stage timers for the charmed meson producers.
+
+Measures the wall-clock time spent in each stage of the candidate search
+(pairing, two-track vertex fits, third track collection, three-track vertex fits,
+candidate selection) and in making the output tables (including the gen-matching),
+using steady_clock scopes around each batch rather than around each pair or triplet.
+Per event, the times can be written to the output together with the number of selected tracks;
+over the job, the times are accumulated together with a histogram of the time per event
+for each stage, and the counters of all streams are combined for a summary at the end of the job.
+Timing is disabled by default, in which case a scope does not read the clock.
+*/
+
+#ifndef StageTimers_H
+#define StageTimers_H
+
+// system include files
+#include <array>
+#include <chrono>
+#include <string>
+
+// nanoaod include files
+#include "DataFormats/NanoAOD/interface/FlatTable.h"
+
+
+class StageTimers {
+  public:
+
+    // stages
+    enum Stage {
+        Pairs,          // collection of the track pairs passing the cheap cuts
+        PairFits,       // two-track vertex fits
+        Triplets,       // collection of the third track candidates
+        TripletFits,    // three-track vertex fits
+        Candidates,     // selection of the candidates after the three-track vertex fit
+        Tables,         // output tables, including the gen-matching
+        nStages
+    };
+    static const std::array<std::string, nStages> stageNames;
+
+    // histogram of the time per event
+    // (note: bin b contains times in [2^(b-1), 2^b) microseconds, bin 0 times below 1 microsecond)
+    static constexpr unsigned nBins = 32;
+
+    // timer for a scope, adds the time between its construction and destruction to a stage
+    class Scope {
+      private:
+        StageTimers* theTimers;
+        Stage theStage;
+        std::chrono::steady_clock::time_point theStart;
+      public:
+        Scope(StageTimers* timers, Stage stage) : theTimers(timers), theStage(stage){
+            if( theTimers ) theStart = std::chrono::steady_clock::now();
+        }
+        ~Scope(){
+            if( !theTimers ) return;
+            std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - theStart;
+            theTimers->theEventTime[theStage] += elapsed.count();
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+  private:
+
+    // settings
+    bool theEnabled = false;
+
+    // times of the current event (in microseconds)
+    std::array<double, nStages> theEventTime{};
+    unsigned long theEventTracks = 0;
+
+    // counters over all events
+    unsigned long theNEvents = 0;
+    unsigned long theNTracks = 0;
+    unsigned long theNPairs = 0;
+    unsigned long theNFits = 0;
+    std::array<double, nStages> theTotalTime{};
+    std::array<std::array<unsigned long, nBins>, nStages> theHistograms{};
+
+  public:
+    // constructor
+    StageTimers(){}
+
+    // switch timing on or off
+    void enable(bool enabled){ theEnabled = enabled; }
+    bool enabled() const { return theEnabled; }
+
+    // start timing a stage of the current event, until the returned scope goes out of scope
+    Scope scope(Stage stage){ return Scope(theEnabled ? this : nullptr, stage); }
+
+    // start a new event
+    void start(){ theEventTime.fill(0.); }
+
+    // add the times of the current event of another instance (e.g. of a parallel chunk)
+    // (note: the times of the chunks are summed, so they are no longer wall-clock times)
+    void add(const StageTimers& other);
+
+    // finish the current event and update the counters over all events
+    void finish(unsigned long nTracks, unsigned long nPairs, unsigned long nFits);
+
+    // add the counters over all events of another instance (e.g. of another stream)
+    void merge(const StageTimers& other);
+
+    // add the number of selected tracks and the time per stage of the current event
+    // as columns to a singleton table
+    void addColumns(nanoaod::FlatTable& table) const;
+
+    // print a summary of the counters over all events
+    void print(const std::string& name) const;
+};
+
+#endif
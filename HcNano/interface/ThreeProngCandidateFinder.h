@@ -0,0 +1,227 @@
+/*
+Reconstruction engine for three-prong charmed meson candidates.
+
+Finds candidates of the form three-prong -> two-prong + third track,
+two-prong -> daughter1 + daughter2, from the preselected tracks of the event.
+The decay channels (mass hypotheses, mass windows and cuts) are given by compile-time policies
+(see ThreeProngDecays.h), so that the hot loops are specialised and inlined per channel;
+the producers only add the gen-matching and fill the output tables.
+
+Several channels can be reconstructed at once (e.g. D* and Ds):
+the loop over track pairs, the charge assignment, the distance of closest approach prefilter
+and the two-track vertex fit are shared between the channels,
+and only the mass hypotheses and cuts are evaluated per channel (see ThreeProngChannel.h).
+The candidates of each channel are the same as when reconstructing that channel alone.
+
+The candidates are found in stages: a batch of track pairs passing the cheap cuts is collected,
+their vertices are fitted in one go, then the third track candidates are collected
+for all pairs with a good vertex, and these are fitted as well
+(one by one, unless a candidate ranking is used, so that no triplet is fitted
+once the maximum number of candidates is reached).
+The pairs are processed in batches of pairBatchSize (rather than all at once),
+so that the search can still stop early when the maximum number of candidates is reached.
+The order of the candidates is the same as for a single nested loop over the tracks.
+
+The two-prong candidates (after the two-track vertex fit) can also be written to the event
+(see TwoProngCandidate.h and TwoProngCandidateProducer.h), and read back by other producers,
+in which case only the stages from the third track onwards are run.
+
+Instead of the first candidates that are found, the best candidates according to a
+configurable score can be kept (see CandidateRanking.h); in that case the search does not
+stop early, but pairs and triplets that can not beat the kept candidates are skipped.
+
+For events with many selected tracks, the loop over the first track of the pairs
+can be split into a fixed number of chunks, which are processed as parallel TBB tasks,
+each by its own copy of the engine (with its own buffers, caches and vertex fitter).
+The candidates of the chunks are merged in the order of the chunks,
+so the output is the same as when processing the event in one go.
+
+The number of pairs tested, the number of vertex fits and the time per event can be limited
+(see EventBudget.h); if a limit is reached, the search stops and the event is flagged as truncated.
+
+Optionally, the pairs and triplets passing each stage of the selection are counted per channel
+(see CutFlow.h); the counters are kept over the events until they are reset by the producer.
+Similarly, the time spent in each stage can be measured (see StageTimers.h);
+the timers are started for each event by the engine, but the event is finished by the producer,
+so that it can add the time spent on its output tables.
+
+The engine owns the magnetic field, the vertex fitter, the two-track DCA prefilter
+and the per-event transient track cache, and adds their settings to the module description.
+*/
+
+#ifndef ThreeProngCandidateFinder_H
+#define ThreeProngCandidateFinder_H
+
+// system include files
+#include <array>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// general include files
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+#include "FWCore/ParameterSet/interface/ParameterSetDescription.h"
+
+// vertex fitter include files
+#include "RecoVertex/VertexPrimitives/interface/TransientVertex.h"
+#include "MagneticField/ParametrizedEngine/src/OAEParametrizedMagneticField.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/SelectedTracks.h"
+#include "PhysicsTools/HcNano/interface/EventRandom.h"
+#include "PhysicsTools/HcNano/interface/TransientTrackCache.h"
+#include "PhysicsTools/HcNano/interface/CandidateVertexFitter.h"
+#include "PhysicsTools/HcNano/interface/CandidateRanking.h"
+#include "PhysicsTools/HcNano/interface/EventBudget.h"
+#include "PhysicsTools/HcNano/interface/StageTimers.h"
+#include "PhysicsTools/HcNano/interface/TwoTrackDCAFilter.h"
+#include "PhysicsTools/HcNano/interface/ThreeProngDecays.h"
+#include "PhysicsTools/HcNano/interface/ThreeProngChannel.h"
+#include "PhysicsTools/HcNano/interface/TwoProngCandidate.h"
+
+
+template<class... Decays> class ThreeProngCandidateFinder {
+  public:
+
+    // number of channels
+    static constexpr size_t nChannels = sizeof...(Decays);
+
+  private:
+
+    // settings
+    const edm::ParameterSet theConfig;
+    const unsigned int thePairBatchSize;
+    const unsigned int theParallelTrackThreshold;
+    const unsigned int theParallelChunks;
+
+    // magnetic field and vertex fitter
+    // (note: both are created once per module instance rather than per event or per pair)
+    const OAEParametrizedMagneticField theBField;
+    CandidateVertexFitter theVertexFitter;
+
+    // prefilter on the distance of closest approach before the two-track vertex fit
+    TwoTrackDCAFilter theDCAFilter;
+
+    // ranking of the candidates
+    CandidateRanking theRanking;
+
+    // per-event limits on the combinatorics
+    EventBudget theBudget;
+
+    // per-stage timers
+    StageTimers theTimers;
+
+    // per-event cache of transient tracks for the vertex fits
+    TransientTrackCache theTransientTracks;
+
+    // channels
+    std::tuple<ThreeProngChannel<Decays>...> theChannels;
+
+    // shared buffers, reused between events
+    std::vector<unsigned> theSecondTrackCandidates;
+    std::vector<double> theTwoTrackDeltaR2;
+    std::vector<double> theTwoTrackSepX;
+    std::vector<double> theTwoTrackSepY;
+    std::vector<double> theTwoTrackSepZ;
+    std::vector<CandidateVertexFitter::Pair> thePairTracks;
+    std::vector<TransientVertex> thePairVertices;
+
+    // copies of the engine for the parallel processing of the chunks of an event
+    // (note: created when first needed, one per chunk)
+    std::vector<std::unique_ptr<ThreeProngCandidateFinder>> theWorkers;
+
+    // call a function on each channel together with its index
+    template<class F> void forEachChannel(F&& f);
+    template<class F, size_t... K> void forEachChannel(F&& f, std::index_sequence<K...>);
+    template<class F> void forEachChannel(F&& f) const;
+    template<class F, size_t... K> void forEachChannel(F&& f, std::index_sequence<K...>) const;
+
+    // count all track pairs of the event in the cut flow of each channel
+    void countPairs(const SelectedTracks& tracks);
+
+    // stage 1: collect a batch of track pairs
+    // (note: only channels that are still active get new pairs)
+    // (note: the random numbers are used to assign same-sign pairs to the daughters)
+    void collectPairs(const SelectedTracks& tracks,
+                      const EventRandom& random,
+                      const std::array<bool, nChannels>& active,
+                      unsigned& firstTrack,
+                      unsigned endTrack);
+
+    // stages 4-5: fit the triplets of a channel and make the output candidates
+    // (note: without ranking, the triplets are fitted one by one,
+    //  and the fits stop as soon as the maximum number of candidates is reached)
+    // (note: returns false if the vertex fit budget for this event is exceeded)
+    template<class Channel>
+    bool fitCandidates(Channel& channel,
+                       const SelectedTracks& tracks,
+                       unsigned maxCandidates,
+                       std::vector<ThreeProngCandidate>& candidates);
+
+    // find the candidates for the pairs with a first track in a given range
+    void findRange(const SelectedTracks& tracks,
+                   const EventRandom& random,
+                   unsigned beginTrack,
+                   unsigned endTrack,
+                   const std::array<unsigned, nChannels>& maxCandidates,
+                   std::array<std::vector<ThreeProngCandidate>, nChannels>& candidates);
+
+    // same, splitting the range of first tracks into chunks processed in parallel
+    void findParallel(const SelectedTracks& tracks,
+                      const EventRandom& random,
+                      const std::array<unsigned, nChannels>& maxCandidates,
+                      std::array<std::vector<ThreeProngCandidate>, nChannels>& candidates);
+
+    // prepare and collect the ranked candidates of all channels
+    // (note: both do nothing if no candidate ranking is used)
+    void resetRanking(const std::array<unsigned, nChannels>& maxCandidates,
+                      const std::array<std::vector<ThreeProngCandidate>, nChannels>& candidates);
+    void collectRankedCandidates(std::array<std::vector<ThreeProngCandidate>, nChannels>& candidates);
+
+  public:
+    // constructor
+    ThreeProngCandidateFinder(const edm::ParameterSet&);
+
+    // add the settings of the engine to a module description
+    static void fillDescriptions(edm::ParameterSetDescription&);
+
+    // find the candidates in an event
+    // (note: the candidates of each channel are appended to the corresponding output vector,
+    //  and the search for a channel stops as soon as it contains maxCandidates candidates,
+    //  or, if a candidate ranking is used, the best maxCandidates candidates are appended)
+    void find(const SelectedTracks& tracks,
+              const edm::EventID& eventID,
+              const std::array<unsigned, nChannels>& maxCandidates,
+              std::array<std::vector<ThreeProngCandidate>, nChannels>& candidates);
+
+    // same, but starting from two-prong candidates read from the event
+    // (note: the two-prong candidates must be made from the same tracks,
+    //  and only the ones passing the cuts of the corresponding channel are used)
+    void find(const SelectedTracks& tracks,
+              const std::array<const std::vector<TwoProngCandidate>*, nChannels>& twoProngs,
+              const std::array<unsigned, nChannels>& maxCandidates,
+              std::array<std::vector<ThreeProngCandidate>, nChannels>& candidates);
+
+    // find only the two-prong candidates with a good two-track vertex in an event
+    // (note: there is no maximum number of two-prong candidates)
+    void findTwoProngs(const SelectedTracks& tracks,
+                       const edm::EventID& eventID,
+                       std::array<std::vector<TwoProngCandidate>, nChannels>& twoProngs);
+
+    // budget counters and truncation flag of the last event
+    const EventBudget& budget() const { return theBudget; }
+
+    // cut-flow counters of the k-th channel
+    CutFlow& cutFlow(size_t k);
+
+    // per-stage timers
+    // (note: the current event must be finished by the caller)
+    StageTimers& timers(){ return theTimers; }
+
+    // print a summary of the prefilter and vertex fit counters
+    void print(const std::string& name) const;
+};
+
+#endif
@@ -0,0 +1,230 @@
+/*
+Per-channel part of the three-prong candidate finder.
+
+Holds the selection logic and the buffers of one decay channel
+(given by a compile-time policy, see ThreeProngDecays.h):
+the mass hypotheses and cuts applied to a track pair,
+the collection of the third track candidates around the two-prong candidates with a good vertex,
+and the selection of the final candidates after the three-track vertex fit.
+
+The loop over track pairs, the charge assignment, the distance of closest approach prefilter
+and the two-track vertex fit do not depend on the mass hypotheses,
+and are done only once per pair in the ThreeProngCandidateFinder,
+so that several channels can share them.
+Alternatively, the two-track candidates can be taken from a TwoProngCandidate collection
+made by another module, in which case only the cuts of this channel are applied to them.
+
+If a candidate ranking is configured (see CandidateRanking.h), the channel keeps the best
+candidates of the event in a bounded priority queue instead of the first ones that are found.
+
+Each channel keeps its own cut-flow counters (see CutFlow.h), as the cuts differ per channel.
+*/
+
+#ifndef ThreeProngChannel_H
+#define ThreeProngChannel_H
+
+// system include files
+#include <vector>
+
+// root classes
+#include <Math/Vector4D.h>
+
+// vertex fitter include files
+#include "RecoVertex/VertexPrimitives/interface/TransientVertex.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/SelectedTracks.h"
+#include "PhysicsTools/HcNano/interface/TransientTrackCache.h"
+#include "PhysicsTools/HcNano/interface/CandidateVertexFitter.h"
+#include "PhysicsTools/HcNano/interface/CandidateRanking.h"
+#include "PhysicsTools/HcNano/interface/CutFlow.h"
+#include "PhysicsTools/HcNano/interface/ThreeProngDecays.h"
+#include "PhysicsTools/HcNano/interface/TwoProngCandidate.h"
+
+
+// three-prong candidate
+// (note: all track indices refer to the SelectedTracks of the event)
+struct ThreeProngCandidate {
+    // tracks of the two-prong candidate, in the order in which they were paired,
+    // by charge, and by role in the decay
+    unsigned track1;
+    unsigned track2;
+    unsigned posTrack;
+    unsigned negTrack;
+    unsigned daughter1Track;
+    unsigned daughter2Track;
+    // third track
+    unsigned track3;
+    // four-vectors
+    ROOT::Math::PtEtaPhiMVector daughter1P4;
+    ROOT::Math::PtEtaPhiMVector daughter2P4;
+    ROOT::Math::PtEtaPhiMVector twoProngP4;
+    ROOT::Math::PtEtaPhiMVector track3P4;
+    ROOT::Math::PtEtaPhiMVector threeProngP4;
+    // separation between the reference points of the two tracks
+    double twoTrackSepX;
+    double twoTrackSepY;
+    double twoTrackSepZ;
+    // separation between the reference point of the third track and the two-prong vertex
+    double thirdTrackSepX;
+    double thirdTrackSepY;
+    double thirdTrackSepZ;
+    // vertex fit quality
+    double twoProngNormChi2;
+    double threeProngNormChi2;
+};
+
+
+template<class Decay> class ThreeProngChannel {
+  public:
+
+    // two-track candidate
+    // (note: pair is the index of the track pair in the batch of two-track vertex fits,
+    //  or CandidateVertexFitter::noPair if the candidate was read from the event)
+    struct PairCandidate {
+        unsigned pair;
+        unsigned track1;
+        unsigned track2;
+        unsigned posTrack;
+        unsigned negTrack;
+        unsigned daughter1Track;
+        unsigned daughter2Track;
+        ROOT::Math::PtEtaPhiMVector daughter1P4;
+        ROOT::Math::PtEtaPhiMVector daughter2P4;
+        ROOT::Math::PtEtaPhiMVector twoProngP4;
+        double sepx;
+        double sepy;
+        double sepz;
+        bool validVertex;
+        double vx;
+        double vy;
+        double vz;
+        double normChi2;
+    };
+
+  private:
+
+    // three-track candidate
+    struct TripletCandidate {
+        unsigned pair;
+        unsigned track3;
+        double sepx;
+        double sepy;
+        double sepz;
+    };
+
+    // buffers, reused between events
+    std::vector<double> theTwoTrackMass2;
+    std::vector<double> theTwoTrackMass2Swapped;
+    std::vector<unsigned> theThirdTrackCandidates;
+    std::vector<double> theThirdTrackDeltaR2;
+    std::vector<double> theThirdTrackSepX;
+    std::vector<double> theThirdTrackSepY;
+    std::vector<double> theThirdTrackSepZ;
+    std::vector<double> theThreeTrackMass2;
+    std::vector<PairCandidate> thePairs;
+    std::vector<TripletCandidate> theTriplets;
+    std::vector<CandidateVertexFitter::Triplet> theTripletTracks;
+    std::vector<TransientVertex> theTripletVertices;
+
+    // pair that passed the selection of this channel but not yet the shared prefilters
+    PairCandidate thePendingPair;
+
+    // best candidates of the event, if a candidate ranking is used
+    BoundedPriorityQueue<ThreeProngCandidate> theRankedCandidates;
+
+    // cut-flow counters (disabled by default)
+    CutFlow theCutFlow;
+
+    // lowest possible score of any candidate made from a pair or a triplet,
+    // used to skip the ones that can not beat the kept candidates
+    double pairScoreBound(const CandidateRanking& ranking, const PairCandidate& pair) const;
+    double tripletScoreBound(const CandidateRanking& ranking, const PairCandidate& pair,
+                             const TrackKinematics& kinematics, unsigned track3) const;
+    double score(const CandidateRanking& ranking, const ThreeProngCandidate& candidate) const;
+
+  public:
+    // constructor
+    ThreeProngChannel(){}
+
+    // clear the candidates of the previous batch
+    void clear();
+
+    // clear the ranked candidates of the previous event
+    void resetRanking(unsigned maxCandidates){ theRankedCandidates.reset(maxCandidates); }
+
+    // evaluate the cheap channel-specific two-track quantities
+    // for a first track and all second track candidates at once
+    void evaluate(const TrackKinematics& kinematics,
+                  unsigned track1,
+                  const std::vector<unsigned>& secondTrackCandidates);
+
+    // cheap selection of a track pair, before the charge assignment
+    // (note: n is the index of the second track in the last block passed to evaluate)
+    bool preselect(const TrackKinematics& kinematics,
+                   unsigned n, unsigned track1, unsigned track2,
+                   double deltaR2, double sepx, double sepy, double sepz);
+
+    // assign the tracks of a preselected pair to the daughters and apply the mass selection
+    // (note: if the pair is selected, it is kept as pending pair until addPendingPair is called)
+    bool select(const SelectedTracks& tracks,
+                unsigned pair, unsigned track1, unsigned track2,
+                unsigned posTrack, unsigned negTrack,
+                double sepx, double sepy, double sepz);
+    void addPendingPair(){ thePairs.push_back(thePendingPair); }
+    size_t nPairs() const { return thePairs.size(); }
+
+    // set the two-track vertices of the pairs from the last batch of pair fits
+    void setPairVertices(const std::vector<TransientVertex>& pairVertices);
+
+    // alternatively, add a two-track candidate read from the event
+    // (note: the cuts of this channel are applied to it,
+    //  returns whether it was added)
+    bool addTwoProng(const TrackKinematics& kinematics, const TwoProngCandidate& twoProng);
+
+    // convert the pairs with a good two-track vertex to two-track candidates for the event
+    void collectTwoProngs(std::vector<TwoProngCandidate>& twoProngs) const;
+
+    // collect the third track candidates for all pairs with a good two-track vertex
+    // (note: if a candidate ranking is used, pairs and triplets that can not beat
+    //  the kept candidates are skipped)
+    void collectTriplets(const SelectedTracks& tracks, CandidateRanking& ranking);
+
+    size_t nTriplets() const { return theTripletTracks.size(); }
+
+    // fit the three-track vertices, of all triplets or of a single one
+    void fitTriplets(CandidateVertexFitter& fitter, TransientTrackCache& transientTracks);
+    void fitTriplet(unsigned t, CandidateVertexFitter& fitter, TransientTrackCache& transientTracks);
+
+    // make the output candidates for all triplets with a good vertex
+    // (note: the candidates are appended to the output vector,
+    //  until it contains maxCandidates candidates;
+    //  if a candidate ranking is used, they are added to the ranked candidates instead)
+    void collectCandidates(const SelectedTracks& tracks,
+                           const CandidateRanking& ranking,
+                           unsigned maxCandidates,
+                           std::vector<ThreeProngCandidate>& candidates);
+
+    // same for a single triplet, after its vertex was fitted
+    void collectCandidate(const SelectedTracks& tracks,
+                          const CandidateRanking& ranking,
+                          unsigned t,
+                          std::vector<ThreeProngCandidate>& candidates);
+
+    // add the ranked candidates of another instance of this channel to the ranked candidates
+    // (note: used to merge the results of events processed in parallel chunks)
+    void mergeRankedCandidates(const ThreeProngChannel& other){
+        theRankedCandidates.merge(other.theRankedCandidates);
+    }
+
+    // append the ranked candidates to the output vector, best first
+    void collectRankedCandidates(std::vector<ThreeProngCandidate>& candidates) const {
+        theRankedCandidates.sorted(candidates);
+    }
+
+    // cut-flow counters
+    CutFlow& cutFlow(){ return theCutFlow; }
+    const CutFlow& cutFlow() const { return theCutFlow; }
+};
+
+#endif
@@ -0,0 +1,97 @@
+/*
+Compile-time decay policies for the three-prong candidate finder.
+
+Each policy describes one reconstruction channel of the form
+  three-prong -> two-prong + third track, two-prong -> daughter1 + daughter2,
+with the mass hypotheses of the tracks, the mass windows, and all selection cuts
+as constexpr members, so that the candidate finder can be specialised per channel.
+
+Conventions:
+- if both daughters of the two-prong candidate have the same mass hypothesis,
+  daughter1 is the positive and daughter2 the negative track;
+  otherwise both assignments are tried and the one closest to the two-prong mass is kept.
+- a minimum pt of 0 disables the corresponding cut.
+
+The policies for the channels with a Higgs boson origin
+only override the cuts that differ from the inclusive channel.
+*/
+
+#ifndef ThreeProngDecays_H
+#define ThreeProngDecays_H
+
+// local include files
+#include "PhysicsTools/HcNano/interface/TrackKinematics.h"
+
+
+// D* -> D0 pi -> K pi pi
+struct DStarDecay {
+    // mass hypotheses (daughter1 = K, daughter2 = pi of the D0, third track = soft pi)
+    static constexpr TrackKinematics::MassHypothesis daughter1 = TrackKinematics::Kaon;
+    static constexpr TrackKinematics::MassHypothesis daughter2 = TrackKinematics::Pion;
+    static constexpr TrackKinematics::MassHypothesis thirdTrack = TrackKinematics::Pion;
+
+    // masses and mass windows
+    static constexpr double twoProngMass = 1.86484;
+    static constexpr double twoProngMassWindow = 0.035;
+    static constexpr double threeProngMass = 1.96847;
+    static constexpr double threeProngMassWindow = 0.1;
+
+    // two-track selection
+    static constexpr double maxTwoTrackDeltaR = 0.4;
+    static constexpr double minTrackPt = 0.;
+    static constexpr double minDaughter1Pt = 0.;
+    static constexpr double maxTwoTrackSepXY = 0.1;
+    static constexpr double maxTwoTrackSepZ = 0.1;
+    static constexpr double maxTwoProngNormChi2 = 5.;
+
+    // third track selection
+    static constexpr double maxThirdTrackDeltaR = 0.1;
+    static constexpr double minThirdTrackPt = 0.5;
+    static constexpr double maxThirdTrackSep = 0.1;
+    static constexpr double maxThreeProngNormChi2 = 5.;
+};
+
+// H -> D* -> D0 pi -> K pi pi
+struct HToDStarDecay : public DStarDecay {
+    static constexpr double minDaughter1Pt = 1.;
+    static constexpr double maxTwoTrackSepXY = 0.02;
+    static constexpr double maxTwoTrackSepZ = 0.05;
+};
+
+// Ds -> phi pi -> K K pi
+struct DsDecay {
+    // mass hypotheses (daughter1 = K+, daughter2 = K- of the phi, third track = pi)
+    static constexpr TrackKinematics::MassHypothesis daughter1 = TrackKinematics::Kaon;
+    static constexpr TrackKinematics::MassHypothesis daughter2 = TrackKinematics::Kaon;
+    static constexpr TrackKinematics::MassHypothesis thirdTrack = TrackKinematics::Pion;
+
+    // masses and mass windows
+    static constexpr double twoProngMass = 1.019461;
+    static constexpr double twoProngMassWindow = 0.07;
+    static constexpr double threeProngMass = 1.96847;
+    static constexpr double threeProngMassWindow = 0.1;
+
+    // two-track selection
+    static constexpr double maxTwoTrackDeltaR = 0.27;
+    static constexpr double minTrackPt = 0.6;
+    static constexpr double minDaughter1Pt = 0.;
+    static constexpr double maxTwoTrackSepXY = 0.1;
+    static constexpr double maxTwoTrackSepZ = 0.1;
+    static constexpr double maxTwoProngNormChi2 = 5.;
+
+    // third track selection
+    static constexpr double maxThirdTrackDeltaR = 0.4;
+    static constexpr double minThirdTrackPt = 0.;
+    static constexpr double maxThirdTrackSep = 0.1;
+    static constexpr double maxThreeProngNormChi2 = 5.;
+};
+
+// H -> Ds -> phi pi -> K K pi
+struct HToDsDecay : public DsDecay {
+    static constexpr double maxTwoTrackDeltaR = 0.2;
+    static constexpr double minTrackPt = 1.;
+    static constexpr double maxTwoTrackSepXY = 0.02;
+    static constexpr double maxTwoTrackSepZ = 0.05;
+};
+
+#endif
@@ -0,0 +1,90 @@
+/*
+Structure-of-arrays cache of track kinematics for the charmed meson producers.
+
+For each selected track, the quantities needed for the cheap (pre-vertex-fit) selections
+are stored in contiguous arrays: momentum components, pt, eta, phi, charge,
+reference point, and the energy under the pion and kaon mass hypotheses.
+
+The kernels evaluate a given quantity for one reference (a track or a two-track system)
+against a block of tracks at once (typically the candidates returned by the eta-phi grid),
+writing the results to an output array aligned with the block.
+They are written as simple loops without branches, so that they can be vectorized.
+*/
+
+#ifndef TrackKinematics_H
+#define TrackKinematics_H
+
+// system include files
+#include <cstddef>
+#include <vector>
+
+// data format include files
+#include "DataFormats/TrackReco/interface/Track.h"
+
+
+class TrackKinematics {
+  public:
+
+    // mass hypotheses
+    enum MassHypothesis { Pion=0, Kaon=1 };
+    static constexpr double pimass = 0.13957;
+    static constexpr double kmass = 0.493677;
+
+  private:
+
+    // columns
+    std::vector<double> thePx;
+    std::vector<double> thePy;
+    std::vector<double> thePz;
+    std::vector<double> thePt;
+    std::vector<double> theEta;
+    std::vector<double> thePhi;
+    std::vector<int> theCharge;
+    std::vector<double> theVx;
+    std::vector<double> theVy;
+    std::vector<double> theVz;
+    std::vector<double> theEPi;
+    std::vector<double> theEK;
+
+  public:
+    // constructor
+    TrackKinematics(){}
+
+    // fill
+    void push_back(const reco::Track&);
+    void reserve(size_t);
+
+    // access
+    size_t size() const { return thePt.size(); }
+    double px(size_t i) const { return thePx[i]; }
+    double py(size_t i) const { return thePy[i]; }
+    double pz(size_t i) const { return thePz[i]; }
+    double pt(size_t i) const { return thePt[i]; }
+    double eta(size_t i) const { return theEta[i]; }
+    double phi(size_t i) const { return thePhi[i]; }
+    int charge(size_t i) const { return theCharge[i]; }
+    double vx(size_t i) const { return theVx[i]; }
+    double vy(size_t i) const { return theVy[i]; }
+    double vz(size_t i) const { return theVz[i]; }
+    double energy(size_t i, MassHypothesis hyp) const { return (hyp==Pion) ? theEPi[i] : theEK[i]; }
+
+    // kernels
+    // squared deltaR between a direction (eta, phi) and each track in the block
+    void deltaR2(double eta, double phi,
+                 const std::vector<unsigned>& block,
+                 std::vector<double>& out) const;
+    // absolute separation between a point (x, y, z) and the reference point of each track in the block
+    void separation(double x, double y, double z,
+                    const std::vector<unsigned>& block,
+                    std::vector<double>& outx,
+                    std::vector<double>& outy,
+                    std::vector<double>& outz) const;
+    // squared invariant mass of a four-vector (e, px, py, pz)
+    // combined with each track in the block under the given mass hypothesis
+    void mass2(double e, double px, double py, double pz,
+               MassHypothesis hyp,
+               const std::vector<unsigned>& block,
+               std::vector<double>& out) const;
+};
+
+#endif
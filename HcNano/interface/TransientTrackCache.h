@@ -0,0 +1,53 @@
+/*
+Per-event cache of transient tracks for the vertex fits in the charmed meson producers.
+
+The transient tracks are indexed by the position of the track in the SelectedTracks product,
+and are only built the first time they are requested,
+so that each selected track is turned into a transient track at most once per event,
+regardless of how many pair and triplet fits it takes part in.
+Building the transient track is the only place where a selected track is copied,
+as the transient track needs to own its track.
+*/
+
+#ifndef TransientTrackCache_H
+#define TransientTrackCache_H
+
+// system include files
+#include <cstddef>
+#include <vector>
+
+// data format include files
+#include "DataFormats/TrackReco/interface/Track.h"
+
+// transient track include files
+#include "MagneticField/Engine/interface/MagneticField.h"
+#include "TrackingTools/TransientTrack/interface/TransientTrack.h"
+
+
+class TransientTrackCache {
+  private:
+
+    // tracks and magnetic field the transient tracks are built from
+    const std::vector<const reco::Track*>* theTracks = nullptr;
+    const MagneticField* theField = nullptr;
+
+    // transient tracks, and flags whether they were already built
+    std::vector<reco::TransientTrack> theTransientTracks;
+    std::vector<bool> theIsBuilt;
+
+  public:
+    // constructor
+    TransientTrackCache(){}
+
+    // clear the cache and set the tracks for a new event
+    // (note: the tracks and magnetic field must outlive all use of the cache in this event)
+    void reset(const std::vector<const reco::Track*>& tracks, const MagneticField* field);
+
+    // get the transient track for the i-th track, building it if needed
+    const reco::TransientTrack& get(size_t i);
+
+    // access
+    size_t size() const { return theTransientTracks.size(); }
+};
+
+#endif
@@ -0,0 +1,46 @@
+/*
+Event product holding a two-prong candidate (e.g. D0 -> K pi or phi -> K K).
+
+The two-prong candidates are made once per event by a TwoProngCandidateProducer
+from the SelectedTracks, after the selection on the track pair and the two-track vertex fit,
+and can be consumed by all three-prong producers for the corresponding decay,
+so that the pairing and the two-track vertex fits are not repeated in each of them.
+All track indices refer to the SelectedTracks product the candidates were made from.
+*/
+
+#ifndef TwoProngCandidate_H
+#define TwoProngCandidate_H
+
+// system include files
+#include <vector>
+
+// root classes
+#include <Math/Vector4D.h>
+
+
+struct TwoProngCandidate {
+    // tracks, in the order in which they were paired, by charge, and by role in the decay
+    unsigned track1 = 0;
+    unsigned track2 = 0;
+    unsigned posTrack = 0;
+    unsigned negTrack = 0;
+    unsigned daughter1Track = 0;
+    unsigned daughter2Track = 0;
+    // four-vectors of the daughters (under their mass hypotheses) and of the candidate
+    ROOT::Math::PtEtaPhiMVector daughter1P4;
+    ROOT::Math::PtEtaPhiMVector daughter2P4;
+    ROOT::Math::PtEtaPhiMVector p4;
+    // separation between the reference points of the two tracks
+    double sepx = 0;
+    double sepy = 0;
+    double sepz = 0;
+    // fitted two-track vertex
+    double vx = 0;
+    double vy = 0;
+    double vz = 0;
+    double normChi2 = 0;
+};
+
+typedef std::vector<TwoProngCandidate> TwoProngCandidateCollection;
+
+#endif
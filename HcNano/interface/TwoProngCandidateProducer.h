@@ -0,0 +1,70 @@
+/*
+Custom analyzer class for finding two-prong candidates from pairs of tracks.
+
+Makes the two-prong candidates (track pairs passing the selection and the two-track vertex fit)
+of a decay channel once per event and writes them to the event,
+so that several three-prong producers for the same decay can consume them
+instead of repeating the pairing and the two-track vertex fits.
+
+The selection is given by the decay policy (see ThreeProngDecays.h);
+the consumers apply their own (tighter) cuts to the candidates on top of it,
+so the loosest policy of all consumers should be used.
+The plugins defined in the corresponding source file are:
+- DZeroCandidateProducer: D0 -> K pi, with the cuts of the D* producer
+- PhiCandidateProducer: phi -> K K, with the cuts of the Ds producer
+*/
+
+#ifndef TwoProngCandidateProducer_H
+#define TwoProngCandidateProducer_H
+
+// system include files
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// general include files
+#include "FWCore/Framework/interface/Frameworkfwd.h"
+#include "FWCore/Framework/interface/global/EDProducer.h"
+#include "FWCore/Framework/interface/Event.h"
+#include "FWCore/Framework/interface/MakerMacros.h"
+#include "FWCore/ParameterSet/interface/ParameterSet.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/SelectedTracks.h"
+#include "PhysicsTools/HcNano/interface/ThreeProngCandidateFinder.h"
+#include "PhysicsTools/HcNano/interface/TwoProngCandidate.h"
+
+
+template<class Decay>
+class TwoProngCandidateProducer : public edm::global::EDProducer<edm::StreamCache<ThreeProngCandidateFinder<Decay>>> {
+  private:
+
+    // attributes and variables
+    const std::string name;
+
+    // settings of the candidate finder
+    // (note: the candidate finder holds buffers, caches and counters,
+    //  so there is one per stream and the module itself has no mutable state,
+    //  apart from the stage timers of all streams combined for the summary at the end of the job)
+    const edm::ParameterSet finderConfig;
+    mutable std::mutex jobTimersMutex;
+    mutable StageTimers jobTimers;
+
+    // template member functions
+    std::unique_ptr<ThreeProngCandidateFinder<Decay>> beginStream(edm::StreamID) const override;
+    void produce(edm::StreamID, edm::Event&, const edm::EventSetup&) const override;
+    void endStream(edm::StreamID) const override;
+    void endJob() override;
+
+    // tokens
+    edm::EDGetTokenT<SelectedTracks> selectedTracksToken;
+
+  public:
+    // constructor, destructor, and other meta-functions
+    explicit TwoProngCandidateProducer(const edm::ParameterSet&);
+    ~TwoProngCandidateProducer() override;
+    static void fillDescriptions(edm::ConfigurationDescriptions&);
+};
+
+#endif
@@ -0,0 +1,48 @@
+/*
+Fast analytic prefilter on the distance of closest approach between two tracks.
+
+The distance of closest approach is calculated analytically from the helix parameters
+(using ClosestApproachInRPhi), which is much cheaper than a Kalman vertex fit,
+and pairs of tracks that are too far apart to share a vertex are rejected before fitting.
+The filter also counts how many pairs were tested and rejected,
+i.e. how many vertex fits were saved.
+A maximum DCA of zero or less disables the filter (all pairs pass, and nothing is printed);
+this is the default, since the signal efficiency of the cut is not yet measured.
+*/
+
+#ifndef TwoTrackDCAFilter_H
+#define TwoTrackDCAFilter_H
+
+// system include files
+#include <string>
+
+// transient track include files
+#include "TrackingTools/TransientTrack/interface/TransientTrack.h"
+
+
+class TwoTrackDCAFilter {
+  private:
+
+    // settings
+    double theMaxDCA;
+
+    // counters
+    unsigned long theNTested = 0;
+    unsigned long theNRejected = 0;
+    unsigned long theNFailed = 0;
+
+  public:
+    // constructor
+    // (note: a maximum distance <= 0 disables the filter)
+    TwoTrackDCAFilter(double maxDCA);
+
+    // check if a pair of tracks passes the filter
+    // (note: if the distance of closest approach can not be calculated,
+    //  e.g. for parallel tracks, the pair is passed on to the vertex fit)
+    bool passes(const reco::TransientTrack&, const reco::TransientTrack&);
+
+    // print a summary of the counters
+    void print(const std::string& name) const;
+};
+
+#endif
@@ -0,0 +1,59 @@
+/*
+Comparison of two vertex fits on a sample of candidates.
+
+Used to validate approximate or faster vertex fits (e.g. the incremental triplet fit
+or the lightweight vertex fitter) against the full Kalman vertex fit.
+For each compared candidate, the selection decision (valid vertex with normalised chi2 in range)
+and the differences in vertex position and normalised chi2 are accumulated,
+and a summary can be printed at the end of the job.
+*/
+
+#ifndef VertexFitComparison_H
+#define VertexFitComparison_H
+
+// system include files
+#include <string>
+
+// vertex fitter include files
+#include "RecoVertex/VertexPrimitives/interface/TransientVertex.h"
+
+
+class VertexFitComparison {
+  private:
+
+    // settings
+    std::string theTitle;
+    unsigned theInterval;
+    double theMaxNormChi2;
+
+    // counters and accumulated differences
+    unsigned long theNCandidates = 0;
+    unsigned long theNCompared = 0;
+    unsigned long theNDecisionMismatch = 0;
+    unsigned long theNBothValid = 0;
+    double theSumDx = 0;
+    double theSumDy = 0;
+    double theSumDz = 0;
+    double theSumDNormChi2 = 0;
+    double theMaxDNormChi2 = 0;
+
+    // helper functions
+    bool passes(const TransientVertex& vertex) const;
+
+  public:
+    // constructor
+    // (note: every interval-th candidate is compared, an interval of 0 disables the comparison,
+    //  maxNormChi2 is the vertex quality cut used to compare the selection decisions)
+    VertexFitComparison(const std::string& title, unsigned interval, double maxNormChi2);
+
+    // decide whether the current candidate should be compared
+    bool sample();
+
+    // compare a vertex fit to the reference fit
+    void fill(const TransientVertex& vertex, const TransientVertex& reference);
+
+    // print a summary of the comparison
+    void print(const std::string& name) const;
+};
+
+#endif
@@ -29,6 +29,7 @@ Custom analyzer class for investigating c-quark fragmentation.
 
 // local include files
 #include "PhysicsTools/HcNano/interface/GenTools.h"
+#include "PhysicsTools/HcNano/interface/GenEventIndex.h"
 
 
 class cFragmentationProducer : public edm::stream::EDProducer<> {
@@ -41,7 +42,7 @@ class cFragmentationProducer : public edm::stream::EDProducer<> {
     void produce(edm::Event&, const edm::EventSetup&) override;
 
     // tokens
-    edm::EDGetTokenT<reco::GenParticleCollection> genParticlesToken;
+    edm::EDGetTokenT<GenEventIndex> genEventIndexToken;
 
   public:
     // constructor, destructor, and other meta-functions
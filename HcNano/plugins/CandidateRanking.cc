@@ -0,0 +1,35 @@
+/*
+Ranking of the three-prong candidates by a quality score.
+*/
+
+// system include files
+#include <iostream>
+
+// general include files
+#include "FWCore/Utilities/interface/Exception.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/CandidateRanking.h"
+
+// constructor //
+CandidateRanking::CandidateRanking(const std::string& score)
+  : theScore(First),
+    theScoreName(score){
+    if( score=="normChi2" ) theScore = NormChi2;
+    else if( score=="massDiff" ) theScore = MassDiff;
+    else if( score=="pt" ) theScore = Pt;
+    else if( score!="first" ){
+        throw cms::Exception("Configuration")
+            << "candidate ranking " << score << " not recognized"
+            << " (expected first, normChi2, massDiff or pt)";
+    }
+}
+
+// summary //
+void CandidateRanking::print(const std::string& name) const {
+    if( !enabled() ) return;
+    std::cout << "Candidate ranking for " << name;
+    std::cout << " (score: " << theScoreName << "):" << std::endl;
+    std::cout << "  pairs skipped (can not beat the kept candidates): " << theNPrunedPairs << std::endl;
+    std::cout << "  triplets skipped (can not beat the kept candidates): " << theNPrunedTriplets << std::endl;
+}
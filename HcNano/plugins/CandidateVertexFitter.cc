@@ -0,0 +1,124 @@
+/*
+Vertex fitting for the two- and three-track candidates in the charmed meson producers.
+*/
+
+// system include files
+#include <iostream>
+#include <vector>
+
+// general include files
+#include "FWCore/Utilities/interface/Exception.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/CandidateVertexFitter.h"
+
+// constructor //
+CandidateVertexFitter::CandidateVertexFitter(
+        const std::string& fitterType,
+        bool incrementalTripletFit,
+        unsigned incrementalComparisonInterval,
+        unsigned lightComparisonInterval,
+        double maxNormChi2)
+  : theUseLightFitter(fitterType=="light"),
+    theIncrementalTripletFit(incrementalTripletFit),
+    theKalmanFitter(false),
+    theIncrementalComparison("Incremental triplet vertex fit vs. Kalman fit",
+        incrementalComparisonInterval, maxNormChi2),
+    theLightPairComparison("Light two-track vertex fit vs. Kalman fit",
+        lightComparisonInterval, maxNormChi2),
+    theLightTripletComparison("Light three-track vertex fit vs. Kalman fit",
+        lightComparisonInterval, maxNormChi2){
+    if( fitterType!="kalman" && fitterType!="light" ){
+        throw cms::Exception("Configuration")
+            << "vertex fitter type " << fitterType << " not recognized"
+            << " (expected kalman or light)";
+    }
+    if( theUseLightFitter && theIncrementalTripletFit ){
+        std::cout << "WARNING: the incremental triplet fit is only available";
+        std::cout << " with the Kalman vertex fitter and will be ignored." << std::endl;
+        theIncrementalTripletFit = false;
+    }
+}
+
+// batch fits //
+void CandidateVertexFitter::fitPairs(
+        const std::vector<Pair>& pairs,
+        TransientTrackCache& tracks,
+        std::vector<TransientVertex>& vertices){
+    vertices.resize(pairs.size());
+    thePairVertices.resize(pairs.size());
+    for(unsigned p=0; p<pairs.size(); p++){
+        vertices[p] = fitPair(tracks.get(pairs[p].track1), tracks.get(pairs[p].track2),
+                              thePairVertices[p]);
+    }
+}
+
+void CandidateVertexFitter::fitTriplets(
+        const std::vector<Triplet>& triplets,
+        TransientTrackCache& tracks,
+        std::vector<TransientVertex>& vertices){
+    vertices.resize(triplets.size());
+    for(unsigned t=0; t<triplets.size(); t++) vertices[t] = fitTriplet(triplets[t], tracks);
+}
+
+TransientVertex CandidateVertexFitter::fitTriplet(
+        const Triplet& triplet,
+        TransientTrackCache& tracks){
+    // (note: triplets without a fitted two-track vertex get an invalid seed,
+    //  so that they are fitted from scratch)
+    static const CachingVertex<5> noSeed;
+    return fitTriplet(tracks.get(triplet.track1), tracks.get(triplet.track2),
+                      tracks.get(triplet.track3),
+                      (triplet.pair==noPair) ? noSeed : thePairVertices[triplet.pair]);
+}
+
+// two-track fit //
+TransientVertex CandidateVertexFitter::fitPair(
+        const reco::TransientTrack& track1,
+        const reco::TransientTrack& track2,
+        CachingVertex<5>& pairVertex){
+    if( theUseLightFitter ){
+        TransientVertex vertex = theLightFitter.vertex(track1, track2);
+        if( theLightPairComparison.sample() ){
+            std::vector<reco::TransientTrack> tracks = {track1, track2};
+            theLightPairComparison.fill(vertex, theKalmanFitter.vertex(tracks));
+        }
+        return vertex;
+    }
+    std::vector<reco::TransientTrack> tracks = {track1, track2};
+    pairVertex = theKalmanFitter.vertex(tracks);
+    return pairVertex;
+}
+
+// three-track fit //
+TransientVertex CandidateVertexFitter::fitTriplet(
+        const reco::TransientTrack& track1,
+        const reco::TransientTrack& track2,
+        const reco::TransientTrack& track3,
+        const CachingVertex<5>& pairVertex){
+    if( theUseLightFitter ){
+        TransientVertex vertex = theLightFitter.vertex(track1, track2, track3);
+        if( theLightTripletComparison.sample() ){
+            std::vector<reco::TransientTrack> tracks = {track1, track2, track3};
+            theLightTripletComparison.fill(vertex, theKalmanFitter.vertex(tracks));
+        }
+        return vertex;
+    }
+    if( theIncrementalTripletFit && pairVertex.isValid() ){
+        TransientVertex vertex = theIncrementalFitter.addTrack(pairVertex, track3);
+        if( theIncrementalComparison.sample() ){
+            std::vector<reco::TransientTrack> tracks = {track1, track2, track3};
+            theIncrementalComparison.fill(vertex, theKalmanFitter.vertex(tracks));
+        }
+        return vertex;
+    }
+    std::vector<reco::TransientTrack> tracks = {track1, track2, track3};
+    return theKalmanFitter.vertex(tracks);
+}
+
+// summary //
+void CandidateVertexFitter::print(const std::string& name) const {
+    theIncrementalComparison.print(name);
+    theLightPairComparison.print(name);
+    theLightTripletComparison.print(name);
+}
@@ -0,0 +1,96 @@
+/*
+Cut-flow counters for the charmed meson producers.
+*/
+
+// system include files
+#include <iomanip>
+#include <iostream>
+
+// local include files
+#include "PhysicsTools/HcNano/interface/CutFlow.h"
+
+// stage names //
+const std::array<std::string, CutFlow::nStages> CutFlow::stageNames = {
+    "pairs",
+    "twoTrackDeltaR",
+    "trackPt",
+    "twoTrackSep",
+    "twoProngMass",
+    "twoTrackDCA",
+    "twoProngFit",
+    "thirdTrackDeltaR",
+    "thirdTrackPt",
+    "thirdTrackSep",
+    "threeProngMass",
+    "threeProngFit"
+};
+
+// all pairs //
+void CutFlow::countPairs(const TrackKinematics& kinematics){
+    if( !theEnabled ) return;
+    unsigned long long nPos = 0;
+    unsigned long long nNeg = 0;
+    for(size_t i=0; i<kinematics.size(); i++){
+        if( kinematics.charge(i)>0 ) nPos++;
+        else if( kinematics.charge(i)<0 ) nNeg++;
+    }
+    // (note: pairs with a neutral track are counted as opposite-sign, as in count)
+    unsigned long long n = kinematics.size();
+    unsigned long long nSS = nPos*(nPos-1)/2 + nNeg*(nNeg-1)/2;
+    theSS[Pairs] += nSS;
+    theOS[Pairs] += n*(n-1)/2 - nSS;
+}
+
+// combine //
+void CutFlow::add(const CutFlow& other){
+    for(size_t s=0; s<nStages; s++){
+        theOS[s] += other.theOS[s];
+        theSS[s] += other.theSS[s];
+    }
+}
+
+// end of luminosity block //
+void CutFlow::reset(){
+    for(size_t s=0; s<nStages; s++){
+        theTotalOS[s] += theOS[s];
+        theTotalSS[s] += theSS[s];
+    }
+    clear();
+}
+
+void CutFlow::clear(){
+    theOS.fill(0);
+    theSS.fill(0);
+}
+
+// output table //
+std::unique_ptr<nanoaod::MergeableCounterTable> CutFlow::makeTable(const std::string& name) const {
+    auto table = std::make_unique<nanoaod::MergeableCounterTable>();
+    for(size_t s=0; s<nStages; s++){
+        table->addInt(name + "_" + stageNames[s] + "_os", "number of opposite-sign "
+            + std::string(s<=TwoProngFit ? "pairs" : "triplets") + " passing " + stageNames[s], theOS[s]);
+        table->addInt(name + "_" + stageNames[s] + "_ss", "number of same-sign "
+            + std::string(s<=TwoProngFit ? "pairs" : "triplets") + " passing " + stageNames[s], theSS[s]);
+    }
+    return table;
+}
+
+// summary //
+void CutFlow::print(const std::string& name) const {
+    if( !theEnabled ) return;
+    if( theTotalOS[Pairs]+theTotalSS[Pairs]==0 ) return;
+    std::cout << "Cut flow for " << name << " (opposite-sign, same-sign):" << std::endl;
+    for(size_t s=0; s<nStages; s++){
+        std::cout << "  " << std::left << std::setw(18) << stageNames[s] << std::right;
+        std::cout << std::setw(14) << theTotalOS[s] << std::setw(14) << theTotalSS[s];
+        // (note: the efficiency is given with respect to the previous stage,
+        //  except for the first triplet stage, which has no well-defined input)
+        if( s>0 && s!=ThirdTrackDeltaR ){
+            double effOS = theTotalOS[s-1]>0 ? double(theTotalOS[s])/theTotalOS[s-1] : 0.;
+            double effSS = theTotalSS[s-1]>0 ? double(theTotalSS[s])/theTotalSS[s-1] : 0.;
+            std::cout << "  (" << std::fixed << std::setprecision(3) << effOS << ", " << effSS << ")";
+            std::cout << std::defaultfloat;
+        }
+        std::cout << std::endl;
+    }
+}
@@ -12,53 +12,166 @@ D* -> D0 pi -> K pi pi
 DStarMesonProducer::DStarMesonProducer(const edm::ParameterSet& iConfig)
   : name(iConfig.getParameter<std::string>("name")),
     dtype(iConfig.getParameter<std::string>("dtype")),
-    packedPFCandidatesToken(consumes<std::vector<pat::PackedCandidate>>(
-        iConfig.getParameter<edm::InputTag>("packedPFCandidatesToken"))),
-    lostTracksToken(consumes<std::vector<pat::PackedCandidate>>(
-        iConfig.getParameter<edm::InputTag>("lostTracksToken"))),
-    genParticlesToken(consumes<std::vector<reco::GenParticle>>(
-        iConfig.getParameter<edm::InputTag>("genParticlesToken"))){
+    finderConfig(iConfig),
+    cutFlow(iConfig.getParameter<bool>("cutFlow")),
+    selectedTracksToken(consumes<SelectedTracks>(
+        iConfig.getParameter<edm::InputTag>("selectedTracksToken"))),
+    genEventIndexToken(consumes<GenEventIndex>(
+        iConfig.getParameter<edm::InputTag>("genEventIndexToken"))){
+    // consume the two-prong candidates if requested
+    const edm::InputTag twoProngCandidatesTag = iConfig.getParameter<edm::InputTag>("twoProngCandidatesToken");
+    useTwoProngCandidates = !twoProngCandidatesTag.label().empty();
+    if( useTwoProngCandidates ){
+        twoProngCandidatesToken = consumes<TwoProngCandidateCollection>(twoProngCandidatesTag);
+    }
     // declare tables to be produced
-    produces<nanoaod::FlatTable>(name);
+    produces<nanoaod::FlatTable>(name); // table of candidates
+    produces<nanoaod::FlatTable>(name+"Budget"); // singleton table of per-event budget flag and counters
+    if( cutFlow ){
+        // cut-flow counters per luminosity block
+        produces<nanoaod::MergeableCounterTable, edm::Transition::EndLuminosityBlock>(name+"CutFlow");
+    }
 }
 
 // destructor //
 DStarMesonProducer::~DStarMesonProducer(){}
 
+// beginning of stream //
+std::unique_ptr<ThreeProngCandidateFinder<DStarDecay>> DStarMesonProducer::beginStream(edm::StreamID) const {
+    return std::make_unique<ThreeProngCandidateFinder<DStarDecay>>(finderConfig);
+}
+
+// end of stream //
+void DStarMesonProducer::endStream(edm::StreamID id) const {
+    streamCache(id)->print(name);
+    std::lock_guard<std::mutex> lock(jobTimersMutex);
+    jobTimers.merge(streamCache(id)->timers());
+}
+
+// end of job //
+void DStarMesonProducer::endJob(){
+    jobTimers.print(name);
+}
+
+// luminosity blocks //
+// (note: the cut-flow counters of each stream are added to the ones of the luminosity block
+//  at the end of the luminosity block in that stream, and then reset)
+std::shared_ptr<CutFlow> DStarMesonProducer::globalBeginLuminosityBlockSummary(
+        const edm::LuminosityBlock&, const edm::EventSetup&) const {
+    return std::make_shared<CutFlow>();
+}
+
+void DStarMesonProducer::streamEndLuminosityBlockSummary(edm::StreamID id,
+        const edm::LuminosityBlock&, const edm::EventSetup&, CutFlow* lumiCutFlow) const {
+    CutFlow& streamCutFlow = streamCache(id)->cutFlow(0);
+    lumiCutFlow->add(streamCutFlow);
+    streamCutFlow.reset();
+}
+
+void DStarMesonProducer::globalEndLuminosityBlockSummary(
+        const edm::LuminosityBlock&, const edm::EventSetup&, CutFlow*) const {}
+
+void DStarMesonProducer::globalEndLuminosityBlockProduce(edm::LuminosityBlock& iLumi,
+        const edm::EventSetup&, const CutFlow* lumiCutFlow) const {
+    if( !cutFlow ) return;
+    iLumi.put(lumiCutFlow->makeTable(name+"CutFlow"), name+"CutFlow");
+}
+
 // descriptions //
 void DStarMesonProducer::fillDescriptions(edm::ConfigurationDescriptions &descriptions){
     edm::ParameterSetDescription desc;
     desc.add<std::string>("name", "Name for output table");
     desc.add<std::string>("dtype", "Data type (mc or data)");
-    desc.add<edm::InputTag>("packedPFCandidatesToken", edm::InputTag("packedPFCandidatesToken"));
-    desc.add<edm::InputTag>("lostTracksToken", edm::InputTag("lostTracksToken"));
-    desc.add<edm::InputTag>("genParticlesToken", edm::InputTag("genParticlesToken"));
+    ThreeProngCandidateFinder<DStarDecay>::fillDescriptions(desc);
+    desc.add<edm::InputTag>("selectedTracksToken", edm::InputTag("selectedTracksToken"));
+    desc.add<edm::InputTag>("genEventIndexToken", edm::InputTag("genEventIndexToken"));
+    desc.add<edm::InputTag>("twoProngCandidatesToken", edm::InputTag(""));
     descriptions.addWithDefaultLabel(desc);
 }
 
 // produce (main method) //
-void DStarMesonProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup){
+void DStarMesonProducer::produce(edm::StreamID id, edm::Event& iEvent, const edm::EventSetup& iSetup) const {
+
+    // candidate finder of this stream
+    ThreeProngCandidateFinder<DStarDecay>& candidateFinder = *streamCache(id);
 
     // get all required objects from tokens
-    edm::Handle<std::vector<pat::PackedCandidate>> packedPFCandidates;
-    iEvent.getByToken(packedPFCandidatesToken, packedPFCandidates);
-    edm::Handle<std::vector<pat::PackedCandidate>> lostTracks;
-    iEvent.getByToken(lostTracksToken, lostTracks);
-    MagneticField* bfield = new OAEParametrizedMagneticField("3_8T");
+    edm::Handle<SelectedTracks> selectedTracksHandle;
+    iEvent.getByToken(selectedTracksToken, selectedTracksHandle);
+    edm::Handle<GenEventIndex> genEventIndexHandle;
+    iEvent.getByToken(genEventIndexToken, genEventIndexHandle);
+
+    // settings for gen-matching
+    const GenEventIndex* genEventIndex = nullptr;
+    if( dtype=="mc" && genEventIndexHandle.isValid() ) genEventIndex = genEventIndexHandle.product();
+
+    // find the candidates
+    // (note: the track pairing, the vertex fits and the selection are done
+    //  by the three-prong candidate finder, specialised for this decay channel.
+    //  merging of packed candidates and lost tracks and the track preselection
+    //  are done only once per event in the SelectedTrackProducer)
+    std::array<std::vector<ThreeProngCandidate>, 1> candidates;
+    if( useTwoProngCandidates ){
+        edm::Handle<TwoProngCandidateCollection> twoProngCandidatesHandle;
+        iEvent.getByToken(twoProngCandidatesToken, twoProngCandidatesHandle);
+        candidateFinder.find(*selectedTracksHandle, {twoProngCandidatesHandle.product()},
+                             {maxCandidates}, candidates);
+    } else candidateFinder.find(*selectedTracksHandle, iEvent.id(), {maxCandidates}, candidates);
+
+    // make the tables and add them to the output
+    // (note: if timing is enabled, the per-event cost is added to the budget table)
+    StageTimers& timers = candidateFinder.timers();
+    {
+        StageTimers::Scope timer = timers.scope(StageTimers::Tables);
+        iEvent.put(makeTable(name, candidates[0], *selectedTracksHandle, genEventIndex), name);
+    }
+    const EventBudget& budget = candidateFinder.budget();
+    timers.finish(selectedTracksHandle->size(), budget.nPairs(), budget.nFits());
+    std::unique_ptr<nanoaod::FlatTable> budgetTable = budget.makeTable(name+"Budget");
+    if( timers.enabled() ) timers.addColumns(*budgetTable);
+    iEvent.put(std::move(budgetTable), name+"Budget");
+}
+
+// make the output table //
+std::unique_ptr<nanoaod::FlatTable> DStarMesonProducer::makeTable(
+        const std::string& name,
+        const std::vector<ThreeProngCandidate>& candidates,
+        const SelectedTracks& selectedTracks,
+        const GenEventIndex* genEventIndex){
+
+    // matcher for the gen-level decay chains
+    // (note: compiled once, at the first call)
+    static const GenDecayMatcher genDecayMatcher({DStarGenDecay::descriptor});
 
     // settings for gen-matching
-    edm::Handle<std::vector<reco::GenParticle>> genParticles;
-    iEvent.getByToken(genParticlesToken, genParticles);
-    std::vector< std::map< std::string, const reco::GenParticle* > > DStarGenParticles;
-    std::vector< std::map< std::string, const reco::GenParticle* > > allDStarGenParticles;
-    bool doMatching = (dtype=="mc") ? true : false;
-    if( !genParticles.isValid() ) doMatching = false;
+    // (note: the hard scattering selection only applies to the D* itself,
+    //  so the chains from the hard scattering are the subset of all chains
+    //  for which the D* has a proton as its mother; they are flagged rather than searched again)
+    std::vector<DStarGenChain> allDStarGenParticles;
+    bool doMatching = (genEventIndex!=nullptr);
     if( doMatching ){
-        DStarGenParticles = DStarMesonGenProducer::find_DStar_to_DZeroPi_to_KPiPi( *genParticles, true );
-        allDStarGenParticles = DStarMesonGenProducer::find_DStar_to_DZeroPi_to_KPiPi( *genParticles, false );
+        GenDecayMatcher::Matches genDecayMatches;
+        genDecayMatcher.match( *genEventIndex, genEventIndex->lastCopies(), genDecayMatches );
+        allDStarGenParticles = makeGenDecayChains<DStarGenDecay>( *genEventIndex, genDecayMatches, 0 );
         if( allDStarGenParticles.size()==0 ) doMatching = false;
     }
 
+    // find the selected tracks matching each gen particle once for all candidates
+    enum GenRole { Pi1Role, KRole, Pi2Role, nGenRoles };
+    enum GenFlag { HardScatterFlag, nGenFlags };
+    GenMatchMasks genMatchMasks;
+    if( doMatching ){
+        double dRThreshold = 0.05;
+        genMatchMasks.reset( selectedTracks, allDStarGenParticles.size(), nGenRoles, nGenFlags, dRThreshold );
+        for(unsigned chain=0; chain<allDStarGenParticles.size(); chain++){
+            const DStarGenChain& genChain = allDStarGenParticles[chain];
+            genMatchMasks.setParticle( chain, Pi1Role, *genChain[DStarGenDecay::Pi1] );
+            genMatchMasks.setParticle( chain, KRole, *genChain[DStarGenDecay::K] );
+            genMatchMasks.setParticle( chain, Pi2Role, *genChain[DStarGenDecay::Pi2] );
+            if( genEventIndex->isHardScatter(genEventIndex->index(*genChain[DStarGenDecay::DStar])) ) genMatchMasks.setFlag( chain, HardScatterFlag );
+        }
+    }
+
     // declare output variables
     std::vector<float> DStarMeson_mass;
     std::vector<float> DStarMeson_pt;
@@ -95,235 +208,82 @@ void DStarMesonProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSet
     std::vector<bool> DStarMeson_hasFastPartialGenMatch;
     std::vector<bool> DStarMeson_hasFastAllOriginGenMatch;
 
-    // merge packed candidate tracks and lost tracks
-    std::vector<reco::Track> allTracks;
-    for(const pat::PackedCandidate& pc: *packedPFCandidates){
-        if(pc.hasTrackDetails()){
-            reco::Track track = *pc.bestTrack();
-            allTracks.push_back(track);
-        }
-    }
-
-    for(const pat::PackedCandidate& pc: *lostTracks){
-        if(pc.hasTrackDetails()){
-            reco::Track track = *pc.bestTrack();
-            allTracks.push_back(track);
-        }
-    }
-
-    // preselect tracks
-    std::vector<reco::Track> selectedTracks;
-    for(const reco::Track& track: allTracks){
-        if(!track.quality(reco::TrackBase::qualityByName("highPurity"))) continue;
-        if(track.pt() < 0.3) continue;
-	    selectedTracks.push_back(track);
-    }
-
-    // loop over pairs of tracks
-    for(unsigned i=0; i<selectedTracks.size(); i++){
-      for(unsigned j=i+1; j<selectedTracks.size(); j++){
-        const reco::Track tr1 = selectedTracks.at(i);
-        const reco::Track tr2 = selectedTracks.at(j);
+    // loop over candidates
+    for(const ThreeProngCandidate& candidate : candidates){
 
-        // candidates must have opposite charge
-        // note: now disabled for study to check if candidates with same charge
-        //       can be used for background estimation.
-        //if(tr1.charge() * tr2.charge() > 0) continue;
+        // retrieve the tracks and four-vectors of the candidate
+        const reco::Track& tr1 = selectedTracks.track(candidate.track1);
+        const reco::Track& tr2 = selectedTracks.track(candidate.track2);
+        const reco::Track& tr3 = selectedTracks.track(candidate.track3);
+        const reco::Track& KTrack = selectedTracks.track(candidate.daughter1Track);
+        const reco::Track& pi2Track = selectedTracks.track(candidate.daughter2Track);
+        const ROOT::Math::PtEtaPhiMVector& KP4 = candidate.daughter1P4;
+        const ROOT::Math::PtEtaPhiMVector& pi2P4 = candidate.daughter2P4;
+        const ROOT::Math::PtEtaPhiMVector& dzeroP4 = candidate.twoProngP4;
+        const ROOT::Math::PtEtaPhiMVector& pi1P4 = candidate.track3P4;
+        const ROOT::Math::PtEtaPhiMVector& dstarP4 = candidate.threeProngP4;
 
-        // candidates must point approximately in the same direction
-        if( reco::deltaR(tr1, tr2) > 0.4 ) continue;
+        // set properties of the D* candidate
+        DStarMeson_mass.push_back( dstarP4.M() );
+        DStarMeson_pt.push_back( dstarP4.pt() );
+        DStarMeson_eta.push_back( dstarP4.eta() );
+        DStarMeson_phi.push_back( dstarP4.phi() );
+        DStarMeson_DZeroMeson_mass.push_back( dzeroP4.M() );
+        DStarMeson_DZeroMeson_pt.push_back( dzeroP4.pt() );
+        DStarMeson_DZeroMeson_eta.push_back( dzeroP4.eta() );
+        DStarMeson_DZeroMeson_phi.push_back( dzeroP4.phi() );
+        DStarMeson_DZeroMeson_massDiff.push_back( dstarP4.M() - dzeroP4.M() );
+        DStarMeson_Pi1_pt.push_back( pi1P4.pt() );
+        DStarMeson_Pi1_eta.push_back( pi1P4.eta() );
+        DStarMeson_Pi1_phi.push_back( pi1P4.phi() );
+        DStarMeson_Pi1_charge.push_back( tr3.charge() );
+        DStarMeson_K_pt.push_back( KP4.pt() );
+        DStarMeson_K_eta.push_back( KP4.eta() );
+        DStarMeson_K_phi.push_back( KP4.phi() );
+        DStarMeson_K_charge.push_back( KTrack.charge() );
+        DStarMeson_Pi2_pt.push_back( pi2P4.pt() );
+        DStarMeson_Pi2_eta.push_back( pi2P4.eta() );
+        DStarMeson_Pi2_phi.push_back( pi2P4.phi() );
+        DStarMeson_Pi2_charge.push_back( pi2Track.charge() );
+        DStarMeson_tr1tr2_deltaR.push_back( reco::deltaR(tr1, tr2) );
+        DStarMeson_tr3d0_deltaR.push_back( reco::deltaR(tr3, dzeroP4) );
+        DStarMeson_d0vtx_normchi2.push_back( candidate.twoProngNormChi2 );
+        DStarMeson_dstarvtx_normchi2.push_back( candidate.threeProngNormChi2 );
+        DStarMeson_tr1tr2_sepx.push_back( candidate.twoTrackSepX );
+        DStarMeson_tr1tr2_sepy.push_back( candidate.twoTrackSepY );
+        DStarMeson_tr1tr2_sepz.push_back( candidate.twoTrackSepZ );
+        DStarMeson_tr3d0_sepx.push_back( candidate.thirdTrackSepX );
+        DStarMeson_tr3d0_sepy.push_back( candidate.thirdTrackSepY );
+        DStarMeson_tr3d0_sepz.push_back( candidate.thirdTrackSepZ );            
 
-        // reference points of both tracks must be close together
-        const math::XYZPoint tr1refpoint = tr1.referencePoint();
-        const math::XYZPoint tr2refpoint = tr2.referencePoint();
-        double twotracksepx = std::abs(tr1refpoint.x()-tr2refpoint.x());
-        double twotracksepy = std::abs(tr1refpoint.y()-tr2refpoint.y());
-        double twotracksepz = std::abs(tr1refpoint.z()-tr2refpoint.z());
-        if( twotracksepx>0.1 || twotracksepy>0.1 || twotracksepz>0.1 ) continue;
-       
-        // find which track is positive and which is negative
-        reco::Track postrack;
-        reco::Track negtrack;
-        if(tr1.charge()>0. and tr2.charge()<0){
-            postrack = tr1;
-            negtrack = tr2;
-        } else if(tr1.charge()<0. and tr2.charge()>0){
-	        postrack = tr2;
-	        negtrack = tr1;
-        } else {
-            // if both tracks have the same charge
-            // (e.g. in combinatorial background),
-            // assign them randomly.
-            if( rand() % 2 == 0 ){
-                postrack = tr1;
-                negtrack = tr2;
-            } else {
-                postrack = tr2;
-                negtrack = tr1;
-            }
+        // check if this candidate can be matched to gen-level
+        bool hasFastGenMatch = false;
+        bool hasFastPartialGenMatch = false;
+        bool hasFastAllOriginGenMatch = false;
+        if( doMatching ){
+            const unsigned t3 = candidate.track3;
+            const unsigned pos = candidate.posTrack;
+            const unsigned neg = candidate.negTrack;
+            auto fullMatch = [&](const GenMatchMasks::View& m){
+                return m.mask(t3, Pi1Role)
+                       & ( (m.mask(pos, KRole) & m.mask(neg, Pi2Role))
+                           | (m.mask(pos, Pi2Role) & m.mask(neg, KRole)) );
+            };
+            auto partialMatch = [&](const GenMatchMasks::View& m){
+                return m.mask(t3, Pi1Role)
+                       | m.mask(pos, KRole) | m.mask(neg, Pi2Role)
+                       | m.mask(pos, Pi2Role) | m.mask(neg, KRole);
+            };
+            hasFastGenMatch = genMatchMasks.any( [&](const GenMatchMasks::View& m){
+                return fullMatch(m) & m.flag(HardScatterFlag); } );
+            hasFastPartialGenMatch = genMatchMasks.any( [&](const GenMatchMasks::View& m){
+                return partialMatch(m) & m.flag(HardScatterFlag); } );
+            hasFastAllOriginGenMatch = genMatchMasks.any( fullMatch );
         }
-
-        // make invariant mass
-        // (note: although the D0 meson decays preferentially to K- pi+ rather than K+ pi-,
-        //  still both possibilities must be considered since the original particle could
-        //  be an anti-D0, which decays preferentially to K+ pi-)
-        ROOT::Math::PtEtaPhiMVector piPlusP4(postrack.pt(), postrack.eta(), postrack.phi(), pimass);
-        ROOT::Math::PtEtaPhiMVector KMinusP4(negtrack.pt(), negtrack.eta(), negtrack.phi(), kmass);
-        ROOT::Math::PtEtaPhiMVector KPlusP4(postrack.pt(), postrack.eta(), postrack.phi(), kmass);
-        ROOT::Math::PtEtaPhiMVector piMinusP4(negtrack.pt(), negtrack.eta(), negtrack.phi(), pimass);
-        ROOT::Math::PtEtaPhiMVector dzeroP4 = piPlusP4 + KMinusP4;
-        ROOT::Math::PtEtaPhiMVector dzerobarP4 = piMinusP4 + KPlusP4;
-        double dzeroInvMass = dzeroP4.M();
-        double dzerobarInvMass = dzerobarP4.M();
-        
-        // invariant mass must be close to resonance mass
-        ROOT::Math::PtEtaPhiMVector pi2P4(0, 0, 0, 0);
-        ROOT::Math::PtEtaPhiMVector KP4(0, 0, 0, 0);
-        reco::Track pi2Track;
-        reco::Track KTrack;
-        if( (std::abs(dzeroInvMass - dzeromass) < 0.035)
-            && (std::abs(dzeroInvMass - dzeromass) < std::abs(dzerobarInvMass - dzeromass)) ){
-            pi2P4 = piPlusP4;
-            KP4 = KMinusP4;
-            pi2Track = postrack;
-            KTrack = negtrack;
-        } else if( (std::abs(dzerobarInvMass - dzeromass) < 0.035) 
-                   && (std::abs(dzerobarInvMass - dzeromass) < std::abs(dzeroInvMass - dzeromass)) ){
-            pi2P4 = piMinusP4;
-            KP4 = KPlusP4;
-            pi2Track = negtrack;
-            KTrack = postrack;
-            dzeroP4 = dzerobarP4;
-            dzeroInvMass = dzerobarInvMass;
-        } else continue;
-
-        // fit a vertex
-        std::vector<reco::TransientTrack> transpair;
-        transpair.push_back(reco::TransientTrack(tr1, bfield));
-        transpair.push_back(reco::TransientTrack(tr2, bfield));
-        KalmanVertexFitter vtxFitter(false);
-        TransientVertex dzerovtx = vtxFitter.vertex(transpair);
-        // vertex must be valid
-        if(!dzerovtx.isValid()) continue;
-        // chi squared of fit must be small
-        if(dzerovtx.normalisedChiSquared()>5.) continue;
-        if(dzerovtx.normalisedChiSquared()<0.) continue;
-        
-        // loop over third track
-	    for(unsigned k=0; k<selectedTracks.size(); k++){
-            if(k==i or k==j) continue;
-            const reco::Track tr3 = selectedTracks.at(k);
-
-            // candidates must point approximately in the same direction
-            if( reco::deltaR(tr3, dzeroP4) > 0.1 ) continue;
-
-            // candidates must have pT greater certain value
-            if( tr3.pt() < 0.5 ) continue;
-
-            // reference point of third track must be close to phi vertex
-            const math::XYZPoint tr3refpoint = tr3.referencePoint();
-            double trackvtxsepx = std::abs(tr3refpoint.x()-dzerovtx.position().x());
-            double trackvtxsepy = std::abs(tr3refpoint.y()-dzerovtx.position().y());
-            double trackvtxsepz = std::abs(tr3refpoint.z()-dzerovtx.position().z());
-            if( trackvtxsepx>0.1 || trackvtxsepy>0.1 || trackvtxsepz>0.1 ) continue;
-
-            // make invariant mass (under the assumption of pi mass for the third track)
-            ROOT::Math::PtEtaPhiMVector pi1P4(tr3.pt(), tr3.eta(), tr3.phi(), pimass);
-            ROOT::Math::PtEtaPhiMVector dstarP4 = dzeroP4 + pi1P4;
-            double dstarInvMass = dstarP4.M();
-
-            // check if mass is close enough to D* mass
-            if(std::abs(dstarInvMass - dstarmass) > 0.1) continue;
-
-            // do a vertex fit
-            std::vector<reco::TransientTrack> transtriplet;
-            transtriplet.push_back(reco::TransientTrack(tr1, bfield));
-            transtriplet.push_back(reco::TransientTrack(tr2, bfield));
-            transtriplet.push_back(reco::TransientTrack(tr3, bfield));
-            TransientVertex dstarvtx = vtxFitter.vertex(transtriplet);
-            if(!dstarvtx.isValid()) continue;
-            if(dstarvtx.normalisedChiSquared()>5.) continue;
-            if(dstarvtx.normalisedChiSquared()<0.) continue;
-
-            // set properties of the D* candidate
-            DStarMeson_mass.push_back( dstarP4.M() );
-            DStarMeson_pt.push_back( dstarP4.pt() );
-            DStarMeson_eta.push_back( dstarP4.eta() );
-            DStarMeson_phi.push_back( dstarP4.phi() );
-            DStarMeson_DZeroMeson_mass.push_back( dzeroP4.M() );
-            DStarMeson_DZeroMeson_pt.push_back( dzeroP4.pt() );
-            DStarMeson_DZeroMeson_eta.push_back( dzeroP4.eta() );
-            DStarMeson_DZeroMeson_phi.push_back( dzeroP4.phi() );
-            DStarMeson_DZeroMeson_massDiff.push_back( dstarP4.M() - dzeroP4.M() );
-            DStarMeson_Pi1_pt.push_back( pi1P4.pt() );
-            DStarMeson_Pi1_eta.push_back( pi1P4.eta() );
-            DStarMeson_Pi1_phi.push_back( pi1P4.phi() );
-            DStarMeson_Pi1_charge.push_back( tr3.charge() );
-            DStarMeson_K_pt.push_back( KP4.pt() );
-            DStarMeson_K_eta.push_back( KP4.eta() );
-            DStarMeson_K_phi.push_back( KP4.phi() );
-            DStarMeson_K_charge.push_back( KTrack.charge() );
-            DStarMeson_Pi2_pt.push_back( pi2P4.pt() );
-            DStarMeson_Pi2_eta.push_back( pi2P4.eta() );
-            DStarMeson_Pi2_phi.push_back( pi2P4.phi() );
-            DStarMeson_Pi2_charge.push_back( pi2Track.charge() );
-            DStarMeson_tr1tr2_deltaR.push_back( reco::deltaR(tr1, tr2) );
-            DStarMeson_tr3d0_deltaR.push_back( reco::deltaR(tr3, dzeroP4) );
-            DStarMeson_d0vtx_normchi2.push_back( dzerovtx.normalisedChiSquared() );
-            DStarMeson_dstarvtx_normchi2.push_back( dstarvtx.normalisedChiSquared() );
-            DStarMeson_tr1tr2_sepx.push_back( twotracksepx );
-            DStarMeson_tr1tr2_sepy.push_back( twotracksepy );
-            DStarMeson_tr1tr2_sepz.push_back( twotracksepz );
-            DStarMeson_tr3d0_sepx.push_back( trackvtxsepx );
-            DStarMeson_tr3d0_sepy.push_back( trackvtxsepy );
-            DStarMeson_tr3d0_sepz.push_back( trackvtxsepz );            
-
-            // check if this candidate can be matched to gen-level
-            bool hasFastGenMatch = false;
-            bool hasFastPartialGenMatch = false;
-            bool hasFastAllOriginGenMatch = false;
-            if( doMatching ){
-                for( const auto& pmap : DStarGenParticles){
-                    double dRThreshold = 0.05;
-                    if( GenTools::isGeometricTrackMatch( tr3, *pmap.at("Pi1"), dRThreshold )
-                        && ( (GenTools::isGeometricTrackMatch( postrack, *pmap.at("K"), dRThreshold )
-                              && GenTools::isGeometricTrackMatch( negtrack, *pmap.at("Pi2"), dRThreshold ) )
-                             || (GenTools::isGeometricTrackMatch( postrack, *pmap.at("Pi2"), dRThreshold )
-                              && GenTools::isGeometricTrackMatch( negtrack, *pmap.at("K"), dRThreshold ) ) ) ){
-                        hasFastGenMatch = true;
-                    }
-                    if( GenTools::isGeometricTrackMatch( tr3, *pmap.at("Pi1"), dRThreshold )
-                         || GenTools::isGeometricTrackMatch( postrack, *pmap.at("K"), dRThreshold )
-                         || GenTools::isGeometricTrackMatch( negtrack, *pmap.at("Pi2"), dRThreshold )
-                         || GenTools::isGeometricTrackMatch( postrack, *pmap.at("Pi2"), dRThreshold )
-                         || GenTools::isGeometricTrackMatch( negtrack, *pmap.at("K"), dRThreshold ) ){
-                        hasFastPartialGenMatch = true;
-                    }
-                }
-                for( const auto& pmap : allDStarGenParticles){
-                    double dRThreshold = 0.05;
-                    if( GenTools::isGeometricTrackMatch( tr3, *pmap.at("Pi1"), dRThreshold )
-                        && ( (GenTools::isGeometricTrackMatch( postrack, *pmap.at("K"), dRThreshold )
-                              && GenTools::isGeometricTrackMatch( negtrack, *pmap.at("Pi2"), dRThreshold ) )
-                             || (GenTools::isGeometricTrackMatch( postrack, *pmap.at("Pi2"), dRThreshold )
-                              && GenTools::isGeometricTrackMatch( negtrack, *pmap.at("K"), dRThreshold ) ) ) ){
-                        hasFastAllOriginGenMatch = true;
-                    }
-                }
-            }
-            DStarMeson_hasFastGenMatch.push_back( hasFastGenMatch );
-            DStarMeson_hasFastPartialGenMatch.push_back( hasFastPartialGenMatch );
-            DStarMeson_hasFastAllOriginGenMatch.push_back( hasFastAllOriginGenMatch );
-
-            // break loop over third track in case maximum number was reached
-            if( DStarMeson_mass.size() == nDStarMeson_max ) break;
-
-        } // end loop over third track
-        if( DStarMeson_mass.size() == nDStarMeson_max ) break;
-      }
-      if( DStarMeson_mass.size()  == nDStarMeson_max) break;
-    } // end loop over first and second track
-    delete bfield;
+        DStarMeson_hasFastGenMatch.push_back( hasFastGenMatch );
+        DStarMeson_hasFastPartialGenMatch.push_back( hasFastPartialGenMatch );
+        DStarMeson_hasFastAllOriginGenMatch.push_back( hasFastAllOriginGenMatch );
+    } // end loop over candidates
 
     // make the table
     auto table = std::make_unique<nanoaod::FlatTable>(DStarMeson_mass.size(), name, false);
@@ -362,8 +322,7 @@ void DStarMesonProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSet
     table->addColumn<bool>("hasFastPartialGenmatch", DStarMeson_hasFastPartialGenMatch, "");
     table->addColumn<bool>("hasFastAllOriginGenmatch", DStarMeson_hasFastAllOriginGenMatch, "");
 
-    // add the table to the output
-    iEvent.put(std::move(table), name);
+    return table;
 }
 
 // define this as a plug-in
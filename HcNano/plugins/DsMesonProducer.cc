@@ -12,53 +12,166 @@ Ds -> phi pi -> K K pi
 DsMesonProducer::DsMesonProducer(const edm::ParameterSet& iConfig)
   : name(iConfig.getParameter<std::string>("name")),
     dtype(iConfig.getParameter<std::string>("dtype")),
-    packedPFCandidatesToken(consumes<std::vector<pat::PackedCandidate>>(
-        iConfig.getParameter<edm::InputTag>("packedPFCandidatesToken"))),
-    lostTracksToken(consumes<std::vector<pat::PackedCandidate>>(
-        iConfig.getParameter<edm::InputTag>("lostTracksToken"))),
-    genParticlesToken(consumes<std::vector<reco::GenParticle>>(
-        iConfig.getParameter<edm::InputTag>("genParticlesToken"))){
+    finderConfig(iConfig),
+    cutFlow(iConfig.getParameter<bool>("cutFlow")),
+    selectedTracksToken(consumes<SelectedTracks>(
+        iConfig.getParameter<edm::InputTag>("selectedTracksToken"))),
+    genEventIndexToken(consumes<GenEventIndex>(
+        iConfig.getParameter<edm::InputTag>("genEventIndexToken"))){
+    // consume the two-prong candidates if requested
+    const edm::InputTag twoProngCandidatesTag = iConfig.getParameter<edm::InputTag>("twoProngCandidatesToken");
+    useTwoProngCandidates = !twoProngCandidatesTag.label().empty();
+    if( useTwoProngCandidates ){
+        twoProngCandidatesToken = consumes<TwoProngCandidateCollection>(twoProngCandidatesTag);
+    }
     // declare tables to be produced
-    produces<nanoaod::FlatTable>(name);
+    produces<nanoaod::FlatTable>(name); // table of candidates
+    produces<nanoaod::FlatTable>(name+"Budget"); // singleton table of per-event budget flag and counters
+    if( cutFlow ){
+        // cut-flow counters per luminosity block
+        produces<nanoaod::MergeableCounterTable, edm::Transition::EndLuminosityBlock>(name+"CutFlow");
+    }
 }
 
 // destructor //
 DsMesonProducer::~DsMesonProducer(){}
 
+// beginning of stream //
+std::unique_ptr<ThreeProngCandidateFinder<DsDecay>> DsMesonProducer::beginStream(edm::StreamID) const {
+    return std::make_unique<ThreeProngCandidateFinder<DsDecay>>(finderConfig);
+}
+
+// end of stream //
+void DsMesonProducer::endStream(edm::StreamID id) const {
+    streamCache(id)->print(name);
+    std::lock_guard<std::mutex> lock(jobTimersMutex);
+    jobTimers.merge(streamCache(id)->timers());
+}
+
+// end of job //
+void DsMesonProducer::endJob(){
+    jobTimers.print(name);
+}
+
+// luminosity blocks //
+// (note: the cut-flow counters of each stream are added to the ones of the luminosity block
+//  at the end of the luminosity block in that stream, and then reset)
+std::shared_ptr<CutFlow> DsMesonProducer::globalBeginLuminosityBlockSummary(
+        const edm::LuminosityBlock&, const edm::EventSetup&) const {
+    return std::make_shared<CutFlow>();
+}
+
+void DsMesonProducer::streamEndLuminosityBlockSummary(edm::StreamID id,
+        const edm::LuminosityBlock&, const edm::EventSetup&, CutFlow* lumiCutFlow) const {
+    CutFlow& streamCutFlow = streamCache(id)->cutFlow(0);
+    lumiCutFlow->add(streamCutFlow);
+    streamCutFlow.reset();
+}
+
+void DsMesonProducer::globalEndLuminosityBlockSummary(
+        const edm::LuminosityBlock&, const edm::EventSetup&, CutFlow*) const {}
+
+void DsMesonProducer::globalEndLuminosityBlockProduce(edm::LuminosityBlock& iLumi,
+        const edm::EventSetup&, const CutFlow* lumiCutFlow) const {
+    if( !cutFlow ) return;
+    iLumi.put(lumiCutFlow->makeTable(name+"CutFlow"), name+"CutFlow");
+}
+
 // descriptions //
 void DsMesonProducer::fillDescriptions(edm::ConfigurationDescriptions &descriptions){
     edm::ParameterSetDescription desc;
     desc.add<std::string>("name", "Name for output table");
     desc.add<std::string>("dtype", "Data type (mc or data)");
-    desc.add<edm::InputTag>("packedPFCandidatesToken", edm::InputTag("packedPFCandidatesToken"));
-    desc.add<edm::InputTag>("lostTracksToken", edm::InputTag("lostTracksToken"));
-    desc.add<edm::InputTag>("genParticlesToken", edm::InputTag("genParticlesToken"));
+    ThreeProngCandidateFinder<DsDecay>::fillDescriptions(desc);
+    desc.add<edm::InputTag>("selectedTracksToken", edm::InputTag("selectedTracksToken"));
+    desc.add<edm::InputTag>("genEventIndexToken", edm::InputTag("genEventIndexToken"));
+    desc.add<edm::InputTag>("twoProngCandidatesToken", edm::InputTag(""));
     descriptions.addWithDefaultLabel(desc);
 }
 
 // produce (main method) //
-void DsMesonProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup){
+void DsMesonProducer::produce(edm::StreamID id, edm::Event& iEvent, const edm::EventSetup& iSetup) const {
+
+    // candidate finder of this stream
+    ThreeProngCandidateFinder<DsDecay>& candidateFinder = *streamCache(id);
 
     // get all required objects from tokens
-    edm::Handle<std::vector<pat::PackedCandidate>> packedPFCandidates;
-    iEvent.getByToken(packedPFCandidatesToken, packedPFCandidates);
-    edm::Handle<std::vector<pat::PackedCandidate>> lostTracks;
-    iEvent.getByToken(lostTracksToken, lostTracks);
-    MagneticField* bfield = new OAEParametrizedMagneticField("3_8T");
+    edm::Handle<SelectedTracks> selectedTracksHandle;
+    iEvent.getByToken(selectedTracksToken, selectedTracksHandle);
+    edm::Handle<GenEventIndex> genEventIndexHandle;
+    iEvent.getByToken(genEventIndexToken, genEventIndexHandle);
+
+    // settings for gen-matching
+    const GenEventIndex* genEventIndex = nullptr;
+    if( dtype=="mc" && genEventIndexHandle.isValid() ) genEventIndex = genEventIndexHandle.product();
+
+    // find the candidates
+    // (note: the track pairing, the vertex fits and the selection are done
+    //  by the three-prong candidate finder, specialised for this decay channel.
+    //  merging of packed candidates and lost tracks and the track preselection
+    //  are done only once per event in the SelectedTrackProducer)
+    std::array<std::vector<ThreeProngCandidate>, 1> candidates;
+    if( useTwoProngCandidates ){
+        edm::Handle<TwoProngCandidateCollection> twoProngCandidatesHandle;
+        iEvent.getByToken(twoProngCandidatesToken, twoProngCandidatesHandle);
+        candidateFinder.find(*selectedTracksHandle, {twoProngCandidatesHandle.product()},
+                             {maxCandidates}, candidates);
+    } else candidateFinder.find(*selectedTracksHandle, iEvent.id(), {maxCandidates}, candidates);
+
+    // make the tables and add them to the output
+    // (note: if timing is enabled, the per-event cost is added to the budget table)
+    StageTimers& timers = candidateFinder.timers();
+    {
+        StageTimers::Scope timer = timers.scope(StageTimers::Tables);
+        iEvent.put(makeTable(name, candidates[0], *selectedTracksHandle, genEventIndex), name);
+    }
+    const EventBudget& budget = candidateFinder.budget();
+    timers.finish(selectedTracksHandle->size(), budget.nPairs(), budget.nFits());
+    std::unique_ptr<nanoaod::FlatTable> budgetTable = budget.makeTable(name+"Budget");
+    if( timers.enabled() ) timers.addColumns(*budgetTable);
+    iEvent.put(std::move(budgetTable), name+"Budget");
+}
+
+// make the output table //
+std::unique_ptr<nanoaod::FlatTable> DsMesonProducer::makeTable(
+        const std::string& name,
+        const std::vector<ThreeProngCandidate>& candidates,
+        const SelectedTracks& selectedTracks,
+        const GenEventIndex* genEventIndex){
+
+    // matcher for the gen-level decay chains
+    // (note: compiled once, at the first call)
+    static const GenDecayMatcher genDecayMatcher({DsGenDecay::descriptor});
 
     // settings for gen-matching
-    edm::Handle<std::vector<reco::GenParticle>> genParticles;
-    iEvent.getByToken(genParticlesToken, genParticles);
-    std::vector< std::map< std::string, const reco::GenParticle* > > DsGenParticles;
-    std::vector< std::map< std::string, const reco::GenParticle* > > allDsGenParticles;
-    bool doMatching = (dtype=="mc") ? true : false;
-    if( !genParticles.isValid() ) doMatching = false;
+    // (note: the hard scattering selection only applies to the Ds itself,
+    //  so the chains from the hard scattering are the subset of all chains
+    //  for which the Ds has a proton as its mother; they are flagged rather than searched again)
+    std::vector<DsGenChain> allDsGenParticles;
+    bool doMatching = (genEventIndex!=nullptr);
     if( doMatching ){
-        DsGenParticles = DsMesonGenProducer::find_Ds_to_PhiPi_to_KKPi( *genParticles, true );
-        allDsGenParticles = DsMesonGenProducer::find_Ds_to_PhiPi_to_KKPi( *genParticles, false );
+        GenDecayMatcher::Matches genDecayMatches;
+        genDecayMatcher.match( *genEventIndex, genEventIndex->lastCopies(), genDecayMatches );
+        allDsGenParticles = makeGenDecayChains<DsGenDecay>( *genEventIndex, genDecayMatches, 0 );
         if( allDsGenParticles.size()==0 ) doMatching = false;
     }
 
+    // find the selected tracks matching each gen particle once for all candidates
+    enum GenRole { PiRole, KPlusRole, KMinusRole, nGenRoles };
+    enum GenFlag { HardScatterFlag, nGenFlags };
+    GenMatchMasks genMatchMasks;
+    if( doMatching ){
+        double dRThreshold = 0.05;
+        genMatchMasks.reset( selectedTracks, allDsGenParticles.size(), nGenRoles, nGenFlags, dRThreshold );
+        for(unsigned chain=0; chain<allDsGenParticles.size(); chain++){
+            const DsGenChain& genChain = allDsGenParticles[chain];
+            genMatchMasks.setParticle( chain, PiRole, *genChain[DsGenDecay::Pi] );
+            genMatchMasks.setParticle( chain, KPlusRole, *genChain[DsGenDecay::KPlus] );
+            genMatchMasks.setParticle( chain, KMinusRole, *genChain[DsGenDecay::KMinus] );
+            if( genEventIndex->isHardScatter(genEventIndex->index(*genChain[DsGenDecay::Ds])) ) genMatchMasks.setFlag( chain, HardScatterFlag );
+        }
+    }
+
     // declare output variables
     std::vector<float> DsMeson_mass;
     std::vector<float> DsMeson_pt;
@@ -95,204 +208,78 @@ void DsMesonProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
     std::vector<bool> DsMeson_hasFastPartialGenMatch;
     std::vector<bool> DsMeson_hasFastAllOriginGenMatch;
 
-    // merge packed candidate tracks and lost tracks
-    std::vector<reco::Track> allTracks;
-    for(const pat::PackedCandidate& pc: *packedPFCandidates){
-        if(pc.hasTrackDetails()){
-            reco::Track track = *pc.bestTrack();
-            allTracks.push_back(track);
-        }
-    }
-
-    for(const pat::PackedCandidate& pc: *lostTracks){
-        if(pc.hasTrackDetails()){
-            reco::Track track = *pc.bestTrack();
-            allTracks.push_back(track);
-        }
-    }
-
-    // preselect tracks
-    std::vector<reco::Track> selectedTracks;
-    for(const reco::Track& track: allTracks){
-        if(!track.quality(reco::TrackBase::qualityByName("highPurity"))) continue;
-        if(track.pt() < 0.3) continue;
-	    selectedTracks.push_back(track);
-    }
-
-    // loop over pairs of tracks
-    for(unsigned i=0; i<selectedTracks.size(); i++){
-      for(unsigned j=i+1; j<selectedTracks.size(); j++){
-        const reco::Track tr1 = selectedTracks.at(i);
-        const reco::Track tr2 = selectedTracks.at(j);
+    // loop over candidates
+    for(const ThreeProngCandidate& candidate : candidates){
 
-        // candidates must have opposite charge
-        // note: now disabled for study to check if candidates with same charge
-        //       can be used for background estimation.
-        //if(tr1.charge() * tr2.charge() > 0) continue;
+        // retrieve the tracks and four-vectors of the candidate
+        const reco::Track& tr1 = selectedTracks.track(candidate.track1);
+        const reco::Track& tr2 = selectedTracks.track(candidate.track2);
+        const reco::Track& tr3 = selectedTracks.track(candidate.track3);
+        const reco::Track& postrack = selectedTracks.track(candidate.posTrack);
+        const reco::Track& negtrack = selectedTracks.track(candidate.negTrack);
+        const ROOT::Math::PtEtaPhiMVector& KPlusP4 = candidate.daughter1P4;
+        const ROOT::Math::PtEtaPhiMVector& KMinusP4 = candidate.daughter2P4;
+        const ROOT::Math::PtEtaPhiMVector& phiP4 = candidate.twoProngP4;
+        const ROOT::Math::PtEtaPhiMVector& piP4 = candidate.track3P4;
+        const ROOT::Math::PtEtaPhiMVector& dsP4 = candidate.threeProngP4;
 
-        // candidates must point approximately in the same direction
-        if( reco::deltaR(tr1, tr2) > 0.27 ) continue;
-	
-        // candidates must have pT greater than certain value
-        if(tr1.pt() < 0.6 or tr2.pt() < 0.6) continue;
+        // set properties of the Ds candidate
+        DsMeson_mass.push_back( dsP4.M() );
+        DsMeson_pt.push_back( dsP4.pt() );
+        DsMeson_eta.push_back( dsP4.eta() );
+        DsMeson_phi.push_back( dsP4.phi() );
+        DsMeson_PhiMeson_mass.push_back( phiP4.M() );
+        DsMeson_PhiMeson_pt.push_back( phiP4.pt() );
+        DsMeson_PhiMeson_eta.push_back( phiP4.eta() );
+        DsMeson_PhiMeson_phi.push_back( phiP4.phi() );
+        DsMeson_PhiMeson_massDiff.push_back( dsP4.M() - phiP4.M() );
+        DsMeson_Pi_pt.push_back( piP4.pt() );
+        DsMeson_Pi_eta.push_back( piP4.eta() );
+        DsMeson_Pi_phi.push_back( piP4.phi() );
+        DsMeson_Pi_charge.push_back( tr3.charge() );
+        DsMeson_KPlus_pt.push_back( KPlusP4.pt() );
+        DsMeson_KPlus_eta.push_back( KPlusP4.eta() );
+        DsMeson_KPlus_phi.push_back( KPlusP4.phi() );
+        DsMeson_KPlus_charge.push_back( postrack.charge() );
+        DsMeson_KMinus_pt.push_back( KMinusP4.pt() );
+        DsMeson_KMinus_eta.push_back( KMinusP4.eta() );
+        DsMeson_KMinus_phi.push_back( KMinusP4.phi() );
+        DsMeson_KMinus_charge.push_back( negtrack.charge() );
+        DsMeson_tr1tr2_deltaR.push_back( reco::deltaR(tr1, tr2) );
+        DsMeson_tr3phi_deltaR.push_back( reco::deltaR(tr3, phiP4) );
+        DsMeson_phivtx_normchi2.push_back( candidate.twoProngNormChi2 );
+        DsMeson_dsvtx_normchi2.push_back( candidate.threeProngNormChi2 );
+        DsMeson_tr1tr2_sepx.push_back( candidate.twoTrackSepX );
+        DsMeson_tr1tr2_sepy.push_back( candidate.twoTrackSepY );
+        DsMeson_tr1tr2_sepz.push_back( candidate.twoTrackSepZ );
+        DsMeson_tr3phi_sepx.push_back( candidate.thirdTrackSepX );
+        DsMeson_tr3phi_sepy.push_back( candidate.thirdTrackSepY );
+        DsMeson_tr3phi_sepz.push_back( candidate.thirdTrackSepZ );
 
-        // reference points of both tracks must be close together
-        const math::XYZPoint tr1refpoint = tr1.referencePoint();
-        const math::XYZPoint tr2refpoint = tr2.referencePoint();
-        double twotracksepx = std::abs(tr1refpoint.x()-tr2refpoint.x());
-        double twotracksepy = std::abs(tr1refpoint.y()-tr2refpoint.y());
-        double twotracksepz = std::abs(tr1refpoint.z()-tr2refpoint.z());
-        if( twotracksepx>0.1 || twotracksepy>0.1 || twotracksepz>0.1 ) continue;
-       
-        // find which track is positive and which is negative
-        reco::Track postrack;
-        reco::Track negtrack;
-        if(tr1.charge()>0. and tr2.charge()<0){
-            postrack = tr1;
-            negtrack = tr2;
-        } else if(tr1.charge()<0. and tr2.charge()>0){
-	        postrack = tr2;
-	        negtrack = tr1;
-        } else {
-            // if both tracks have the same charge
-            // (e.g. in combinatorial background),
-            // assign them randomly.
-            if( rand() % 2 == 0 ){
-                postrack = tr1;
-                negtrack = tr2;
-            } else {
-                postrack = tr2;
-                negtrack = tr1;
-            }
+        // check if this candidate can be matched to gen-level
+        bool hasFastGenMatch = false;
+        bool hasFastPartialGenMatch = false;
+        bool hasFastAllOriginGenMatch = false;
+        if( doMatching ){
+            const unsigned t3 = candidate.track3;
+            const unsigned pos = candidate.posTrack;
+            const unsigned neg = candidate.negTrack;
+            auto fullMatch = [&](const GenMatchMasks::View& m){
+                return m.mask(t3, PiRole) & m.mask(pos, KPlusRole) & m.mask(neg, KMinusRole);
+            };
+            auto partialMatch = [&](const GenMatchMasks::View& m){
+                return m.mask(t3, PiRole) | m.mask(pos, KPlusRole) | m.mask(neg, KMinusRole);
+            };
+            hasFastGenMatch = genMatchMasks.any( [&](const GenMatchMasks::View& m){
+                return fullMatch(m) & m.flag(HardScatterFlag); } );
+            hasFastPartialGenMatch = genMatchMasks.any( [&](const GenMatchMasks::View& m){
+                return partialMatch(m) & m.flag(HardScatterFlag); } );
+            hasFastAllOriginGenMatch = genMatchMasks.any( fullMatch );
         }
-
-        // make invariant mass (under the assumption of K mass for both tracks)
-        ROOT::Math::PtEtaPhiMVector KPlusP4(postrack.pt(), postrack.eta(), postrack.phi(), kmass);
-        ROOT::Math::PtEtaPhiMVector KMinusP4(negtrack.pt(), negtrack.eta(), negtrack.phi(), kmass);
-        ROOT::Math::PtEtaPhiMVector phiP4 = KPlusP4 + KMinusP4;
-        double phiInvMass = phiP4.M();
-
-        // check if mass is close enough to phi mass
-        if(std::abs(phiInvMass - phimass) > 0.07) continue;
-
-        // fit a vertex
-        std::vector<reco::TransientTrack> transpair;
-        transpair.push_back(reco::TransientTrack(tr1, bfield));
-        transpair.push_back(reco::TransientTrack(tr2, bfield));
-        KalmanVertexFitter vtxFitter(false);
-        TransientVertex phivtx = vtxFitter.vertex(transpair);
-        // vertex must be valid
-        if(!phivtx.isValid()) continue;
-        // chi squared of fit must be small
-        if(phivtx.normalisedChiSquared()>5.) continue;
-        if(phivtx.normalisedChiSquared()<0.) continue;
-        
-        // loop over third track
-	    for(unsigned k=0; k<selectedTracks.size(); k++){
-            if(k==i or k==j) continue;
-            const reco::Track tr3 = selectedTracks.at(k);
-
-            // candidates must point approximately in the same direction
-            if( reco::deltaR(tr3, phiP4) > 0.4 ) continue;
-
-            // reference point of third track must be close to phi vertex
-            const math::XYZPoint tr3refpoint = tr3.referencePoint();
-            double trackvtxsepx = std::abs(tr3refpoint.x()-phivtx.position().x());
-            double trackvtxsepy = std::abs(tr3refpoint.y()-phivtx.position().y());
-            double trackvtxsepz = std::abs(tr3refpoint.z()-phivtx.position().z());
-            if( trackvtxsepx>0.1 || trackvtxsepy>0.1 || trackvtxsepz>0.1 ) continue;
-
-            // make invariant mass (under the assumption of pi mass for the third track)
-            ROOT::Math::PtEtaPhiMVector piP4(tr3.pt(), tr3.eta(), tr3.phi(), pimass);
-            ROOT::Math::PtEtaPhiMVector dsP4 = phiP4 + piP4;
-            double dsInvMass = dsP4.M();
-
-            // check if mass is close enough to Ds mass
-            if(std::abs(dsInvMass - dsmass) > 0.1) continue;
-
-            // do a vertex fit
-            std::vector<reco::TransientTrack> transtriplet;
-            transtriplet.push_back(reco::TransientTrack(tr1, bfield));
-            transtriplet.push_back(reco::TransientTrack(tr2, bfield));
-            transtriplet.push_back(reco::TransientTrack(tr3, bfield));
-            TransientVertex dsvtx = vtxFitter.vertex(transtriplet);
-            if(!dsvtx.isValid()) continue;
-            if(dsvtx.normalisedChiSquared()>5.) continue;
-            if(dsvtx.normalisedChiSquared()<0.) continue;
-
-            // set properties of the Ds candidate
-            DsMeson_mass.push_back( dsP4.M() );
-            DsMeson_pt.push_back( dsP4.pt() );
-            DsMeson_eta.push_back( dsP4.eta() );
-            DsMeson_phi.push_back( dsP4.phi() );
-            DsMeson_PhiMeson_mass.push_back( phiP4.M() );
-            DsMeson_PhiMeson_pt.push_back( phiP4.pt() );
-            DsMeson_PhiMeson_eta.push_back( phiP4.eta() );
-            DsMeson_PhiMeson_phi.push_back( phiP4.phi() );
-            DsMeson_PhiMeson_massDiff.push_back( dsP4.M() - phiP4.M() );
-            DsMeson_Pi_pt.push_back( piP4.pt() );
-            DsMeson_Pi_eta.push_back( piP4.eta() );
-            DsMeson_Pi_phi.push_back( piP4.phi() );
-            DsMeson_Pi_charge.push_back( tr3.charge() );
-            DsMeson_KPlus_pt.push_back( KPlusP4.pt() );
-            DsMeson_KPlus_eta.push_back( KPlusP4.eta() );
-            DsMeson_KPlus_phi.push_back( KPlusP4.phi() );
-            DsMeson_KPlus_charge.push_back( postrack.charge() );
-            DsMeson_KMinus_pt.push_back( KMinusP4.pt() );
-            DsMeson_KMinus_eta.push_back( KMinusP4.eta() );
-            DsMeson_KMinus_phi.push_back( KMinusP4.phi() );
-            DsMeson_KMinus_charge.push_back( negtrack.charge() );
-            DsMeson_tr1tr2_deltaR.push_back( reco::deltaR(tr1, tr2) );
-            DsMeson_tr3phi_deltaR.push_back( reco::deltaR(tr3, phiP4) );
-            DsMeson_phivtx_normchi2.push_back( phivtx.normalisedChiSquared() );
-            DsMeson_dsvtx_normchi2.push_back( dsvtx.normalisedChiSquared() );
-            DsMeson_tr1tr2_sepx.push_back( twotracksepx );
-            DsMeson_tr1tr2_sepy.push_back( twotracksepy );
-            DsMeson_tr1tr2_sepz.push_back( twotracksepz );
-            DsMeson_tr3phi_sepx.push_back( trackvtxsepx );
-            DsMeson_tr3phi_sepy.push_back( trackvtxsepy );
-            DsMeson_tr3phi_sepz.push_back( trackvtxsepz );
-
-            // check if this candidate can be matched to gen-level
-            bool hasFastGenMatch = false;
-            bool hasFastPartialGenMatch = false;
-            bool hasFastAllOriginGenMatch = false;
-            if( doMatching ){
-                for( const auto& pmap : DsGenParticles){
-                    double dRThreshold = 0.05;
-                    if( GenTools::isGeometricTrackMatch( tr3, *pmap.at("Pi"), dRThreshold )
-                        && GenTools::isGeometricTrackMatch( postrack, *pmap.at("KPlus"), dRThreshold )
-                        && GenTools::isGeometricTrackMatch( negtrack, *pmap.at("KMinus"), dRThreshold ) ){
-                        hasFastGenMatch = true;
-                    }
-                    if( GenTools::isGeometricTrackMatch( tr3, *pmap.at("Pi"), dRThreshold )
-                        || GenTools::isGeometricTrackMatch( postrack, *pmap.at("KPlus"), dRThreshold )
-                        || GenTools::isGeometricTrackMatch( negtrack, *pmap.at("KMinus"), dRThreshold ) ){
-                        hasFastPartialGenMatch = true;
-                    }
-                }
-                for( const auto& pmap : allDsGenParticles){
-                    double dRThreshold = 0.05;
-                    if( GenTools::isGeometricTrackMatch( tr3, *pmap.at("Pi"), dRThreshold )
-                        && GenTools::isGeometricTrackMatch( postrack, *pmap.at("KPlus"), dRThreshold )
-                        && GenTools::isGeometricTrackMatch( negtrack, *pmap.at("KMinus"), dRThreshold ) ){
-                        hasFastAllOriginGenMatch = true;
-                    }
-                }
-            }
-            DsMeson_hasFastGenMatch.push_back( hasFastGenMatch );
-            DsMeson_hasFastPartialGenMatch.push_back( hasFastPartialGenMatch );
-            DsMeson_hasFastAllOriginGenMatch.push_back( hasFastAllOriginGenMatch );
-
-            // break loop over third track in case maximum number was reached
-            if( DsMeson_mass.size() == nDsMeson_max ) break;
-
-        } // end loop over third track
-        if( DsMeson_mass.size() == nDsMeson_max ) break;
-      }
-      if( DsMeson_mass.size() == nDsMeson_max) break;
-    } // end loop over first and second track
-    delete bfield;
+        DsMeson_hasFastGenMatch.push_back( hasFastGenMatch );
+        DsMeson_hasFastPartialGenMatch.push_back( hasFastPartialGenMatch );
+        DsMeson_hasFastAllOriginGenMatch.push_back( hasFastAllOriginGenMatch );
+    } // end loop over candidates
 
     // make the table
     auto table = std::make_unique<nanoaod::FlatTable>(DsMeson_mass.size(), name, false);
@@ -331,8 +318,7 @@ void DsMesonProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup)
     table->addColumn<bool>("hasFastPartialGenmatch", DsMeson_hasFastPartialGenMatch, "");
     table->addColumn<bool>("hasFastAllOriginGenmatch", DsMeson_hasFastAllOriginGenMatch, "");
 
-    // add the table to the output
-    iEvent.put(std::move(table), name);
+    return table;
 }
 
 // define this as a plug-in
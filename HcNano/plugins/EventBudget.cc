@@ -0,0 +1,78 @@
+/*
+Per-event budget for the combinatorics of the charmed meson producers.
+*/
+
+// system include files
+#include <iostream>
+
+// local include files
+#include "PhysicsTools/HcNano/interface/EventBudget.h"
+
+// constructor //
+EventBudget::EventBudget(unsigned long maxPairs, unsigned long maxFits, double maxTime)
+  : theMaxPairs(maxPairs),
+    theMaxFits(maxFits),
+    theMaxTime(maxTime){}
+
+// start of event //
+void EventBudget::start(unsigned nShares){
+    theEventMaxPairs = (theMaxPairs==0) ? 0 : (theMaxPairs + nShares - 1)/nShares;
+    theEventMaxFits = (theMaxFits==0) ? 0 : (theMaxFits + nShares - 1)/nShares;
+    theNPairs = 0;
+    theNFits = 0;
+    theTruncated = false;
+    if( theMaxTime > 0 ) theStart = std::chrono::steady_clock::now();
+}
+
+// vertex fits //
+bool EventBudget::countFits(unsigned long nFits){
+    if( theEventMaxFits>0 && theNFits + nFits > theEventMaxFits ){
+        theTruncated = true;
+        return false;
+    }
+    theNFits += nFits;
+    return true;
+}
+
+// time //
+bool EventBudget::checkTime(){
+    if( theMaxTime <= 0 ) return true;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - theStart;
+    if( elapsed.count() <= theMaxTime ) return true;
+    theTruncated = true;
+    return false;
+}
+
+// combine //
+void EventBudget::add(const EventBudget& other){
+    theNPairs += other.theNPairs;
+    theNFits += other.theNFits;
+    theTruncated = theTruncated || other.theTruncated;
+}
+
+// end of event //
+void EventBudget::finish(){
+    theNEvents++;
+    if( theTruncated ) theNTruncatedEvents++;
+}
+
+// output table //
+std::unique_ptr<nanoaod::FlatTable> EventBudget::makeTable(const std::string& name) const {
+    auto table = std::make_unique<nanoaod::FlatTable>(1, name, true);
+    table->addColumnValue<bool>("truncated", theTruncated,
+        "candidate search stopped early because the per-event budget was exceeded");
+    table->addColumnValue<int>("nPairs", theNPairs, "number of track pairs tested");
+    table->addColumnValue<int>("nFits", theNFits, "number of vertex fits done");
+    return table;
+}
+
+// summary //
+void EventBudget::print(const std::string& name) const {
+    if( theNEvents==0 ) return;
+    if( theMaxPairs==0 && theMaxFits==0 && theMaxTime<=0 ) return;
+    std::cout << "Per-event budget for " << name;
+    std::cout << " (max. pairs: " << theMaxPairs << ", max. vertex fits: " << theMaxFits;
+    std::cout << ", max. time: " << theMaxTime << " s, 0 means no limit):" << std::endl;
+    std::cout << "  events: " << theNEvents << std::endl;
+    std::cout << "  truncated events: " << theNTruncatedEvents << std::endl;
+}
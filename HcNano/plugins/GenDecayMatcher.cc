@@ -0,0 +1,323 @@
+/*
+Matcher for gen-level decay chains, defined by decay descriptors.
+*/
+
+// system include files
+#include <cctype>
+#include <climits>
+#include <cstdlib>
+
+// general include files
+#include "FWCore/Utilities/interface/Exception.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/GenDecayMatcher.h"
+
+
+namespace {
+
+    // hadron classes
+    // (note: implemented with the same pdg id ranges as used before in each producer separately)
+    enum HadronClass { NoClass, CharmHadronClass, BHadronClass };
+
+    bool inHadronClass(int hadronClass, int pdgId){
+        int absId = std::abs(pdgId);
+        if( hadronClass==CharmHadronClass ){
+            return (absId > 400 && absId < 500) || (absId > 4000 && absId < 5000);
+        }
+        if( hadronClass==BHadronClass ){
+            return (absId > 500 && absId < 600) || (absId > 5000 && absId < 6000);
+        }
+        return false;
+    }
+
+    // particle names
+    // (note: the names of antiparticles follow the usual conventions, e.g. c~, D~0, B~0;
+    //  to be extended as needed)
+    const std::unordered_map<std::string, int>& particleTable(){
+        static const std::unordered_map<std::string, int> table = {
+            {"d", 1}, {"d~", -1}, {"u", 2}, {"u~", -2}, {"s", 3}, {"s~", -3},
+            {"c", 4}, {"c~", -4}, {"b", 5}, {"b~", -5}, {"t", 6}, {"t~", -6},
+            {"e-", 11}, {"e+", -11}, {"mu-", 13}, {"mu+", -13}, {"tau-", 15}, {"tau+", -15},
+            {"g", 21}, {"gamma", 22}, {"Z0", 23}, {"W+", 24}, {"W-", -24}, {"H", 25},
+            {"pi0", 111}, {"pi+", 211}, {"pi-", -211}, {"rho0", 113}, {"eta", 221}, {"omega", 223},
+            {"K_L0", 130}, {"K_S0", 310}, {"K0", 311}, {"K~0", -311}, {"K+", 321}, {"K-", -321},
+            {"eta'", 331}, {"phi", 333},
+            {"D+", 411}, {"D-", -411}, {"D0", 421}, {"D~0", -421}, {"D_s+", 431}, {"D_s-", -431},
+            {"D*+", 413}, {"D*-", -413}, {"D*0", 423}, {"D*~0", -423}, {"D_s*+", 433}, {"D_s*-", -433},
+            {"J/psi", 443},
+            {"B0", 511}, {"B~0", -511}, {"B+", 521}, {"B-", -521}, {"B_s0", 531}, {"B_s~0", -531},
+            {"Upsilon", 553},
+            {"p+", 2212}, {"p~-", -2212}, {"n0", 2112}, {"n~0", -2112},
+            {"Lambda_c+", 4122}, {"Lambda_c~-", -4122}, {"Lambda_b0", 5122}, {"Lambda_b~0", -5122}
+        };
+        return table;
+    }
+
+    bool isSelfConjugate(int pdgId){
+        switch( pdgId ){
+            case 21: case 22: case 23: case 25:
+            case 111: case 113: case 130: case 221: case 223: case 310:
+            case 331: case 333: case 443: case 553:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // descriptor as parsed, before it is stored breadth-first
+    struct ParsedNode {
+        std::vector<int> pdgIds;
+        int hadronClass = NoClass;
+        bool decays = false;
+        bool inclusive = false;
+        std::vector<ParsedNode> daughters;
+    };
+
+    bool operator==(const ParsedNode& a, const ParsedNode& b){
+        return a.pdgIds==b.pdgIds && a.hadronClass==b.hadronClass
+            && a.decays==b.decays && a.inclusive==b.inclusive && a.daughters==b.daughters;
+    }
+
+    // charge conjugate of a parsed descriptor
+    // (note: the decays of self-conjugate particles are left as they are,
+    //  so that e.g. the K+ of a phi -> K+ K- decay keeps its role)
+    ParsedNode conjugate(const ParsedNode& node){
+        if( node.hadronClass==NoClass ){
+            bool selfConjugate = true;
+            for(int pdgId : node.pdgIds){ if( !isSelfConjugate(pdgId) ) selfConjugate = false; }
+            if( selfConjugate ) return node;
+        }
+        ParsedNode res = node;
+        for(int& pdgId : res.pdgIds){ if( !isSelfConjugate(pdgId) ) pdgId = -pdgId; }
+        for(ParsedNode& daughter : res.daughters) daughter = conjugate(daughter);
+        return res;
+    }
+
+    // parser for decay descriptors
+    class DescriptorParser {
+      private:
+        const std::string& theDescriptor;
+        std::vector<std::string> theTokens;
+        size_t thePosition = 0;
+
+        const std::string& peek() const {
+            static const std::string end;
+            return (thePosition < theTokens.size()) ? theTokens[thePosition] : end;
+        }
+        void expect(const std::string& token){
+            if( peek()!=token ) error("expected '" + token + "'");
+            thePosition++;
+        }
+        [[noreturn]] void error(const std::string& message) const {
+            throw cms::Exception("GenDecayMatcher")
+                << "could not parse decay descriptor '" << theDescriptor << "': "
+                << message << " at token " << thePosition << " ('" << peek() << "')";
+        }
+
+        void addName(const std::string& name, ParsedNode& node) const {
+            if( node.hadronClass!=NoClass ) error("hadron classes cannot be combined with other particles");
+            if( name=="CharmHadron" || name=="BHadron" ){
+                if( node.pdgIds.size()>0 ) error("hadron classes cannot be combined with other particles");
+                node.hadronClass = (name=="CharmHadron") ? CharmHadronClass : BHadronClass;
+                return;
+            }
+            auto it = particleTable().find(name);
+            if( it==particleTable().end() ) error("unknown particle '" + name + "'");
+            node.pdgIds.push_back(it->second);
+        }
+
+        ParsedNode parseParticle(){
+            ParsedNode node;
+            if( peek()=="{" ){
+                thePosition++;
+                while( peek()!="}" ){
+                    if( peek().empty() ) error("unterminated set of particles");
+                    addName(peek(), node);
+                    thePosition++;
+                }
+                thePosition++;
+                if( node.hadronClass==NoClass && node.pdgIds.empty() ) error("empty set of particles");
+            } else{
+                const std::string& name = peek();
+                if( name.empty() || name=="(" || name==")" || name=="[" || name=="]"
+                    || name=="->" || name=="..." ) error("expected a particle");
+                addName(name, node);
+                thePosition++;
+            }
+            return node;
+        }
+
+        ParsedNode parseDecay(){
+            ParsedNode node = parseParticle();
+            if( peek()!="->" ) return node;
+            thePosition++;
+            node.decays = true;
+            while( !peek().empty() && peek()!=")" && peek()!="]" ){
+                if( peek()=="..." ){
+                    node.inclusive = true;
+                    thePosition++;
+                    break;
+                }
+                if( peek()=="(" ){
+                    thePosition++;
+                    node.daughters.push_back(parseDecay());
+                    expect(")");
+                } else node.daughters.push_back(parseParticle());
+            }
+            if( node.daughters.empty() ) error("decay without daughters");
+            return node;
+        }
+
+      public:
+        explicit DescriptorParser(const std::string& descriptor) : theDescriptor(descriptor){
+            // split into tokens
+            // (note: brackets and arrows are separate tokens, other tokens are separated by spaces)
+            std::string current;
+            auto flush = [&](){ if( !current.empty() ){ theTokens.push_back(current); current.clear(); } };
+            for(size_t i=0; i < descriptor.size(); i++){
+                char ch = descriptor[i];
+                if( std::isspace(static_cast<unsigned char>(ch)) ) flush();
+                else if( ch=='(' || ch==')' || ch=='[' || ch==']' || ch=='{' || ch=='}' ){
+                    flush();
+                    theTokens.push_back(std::string(1, ch));
+                } else if( ch=='-' && i+1 < descriptor.size() && descriptor[i+1]=='>' ){
+                    flush();
+                    theTokens.push_back("->");
+                    i++;
+                } else current += ch;
+            }
+            flush();
+        }
+
+        // parse the full descriptor
+        ParsedNode parse(bool& chargeConjugate){
+            chargeConjugate = false;
+            ParsedNode res;
+            if( peek()=="[" ){
+                thePosition++;
+                res = parseDecay();
+                expect("]");
+                expect("cc");
+                chargeConjugate = true;
+            } else res = parseDecay();
+            if( !peek().empty() ) error("unexpected token");
+            return res;
+        }
+    };
+}
+
+// constructor //
+GenDecayMatcher::GenDecayMatcher(const std::vector<std::string>& descriptors)
+  : theDescriptors(descriptors){
+    for(unsigned i=0; i < descriptors.size(); i++){
+
+        // parse the descriptor and add its charge conjugate if requested
+        // (note: the charge conjugate is skipped if it is identical, e.g. for H -> c c~)
+        bool chargeConjugate = false;
+        std::vector<ParsedNode> trees = {DescriptorParser(descriptors[i]).parse(chargeConjugate)};
+        if( chargeConjugate ){
+            ParsedNode conjugateTree = conjugate(trees[0]);
+            if( !(conjugateTree==trees[0]) ) trees.push_back(conjugateTree);
+        }
+
+        // store the particles breadth-first
+        for(const ParsedNode& tree : trees){
+            Variant variant;
+            variant.descriptor = i;
+            std::vector<const ParsedNode*> queue = {&tree};
+            for(size_t q=0; q < queue.size(); q++){
+                const ParsedNode& parsed = *queue[q];
+                Node node;
+                node.pdgIds = parsed.pdgIds;
+                node.hadronClass = parsed.hadronClass;
+                node.decays = parsed.decays;
+                node.inclusive = parsed.inclusive;
+                node.firstDaughter = queue.size();
+                node.nDaughters = parsed.daughters.size();
+                for(const ParsedNode& daughter : parsed.daughters) queue.push_back(&daughter);
+                variant.nodes.push_back(node);
+            }
+
+            // index the variant by the pdg id of its mother
+            unsigned index = theVariants.size();
+            if( tree.hadronClass!=NoClass ) theClassVariants.push_back(index);
+            for(int pdgId : tree.pdgIds) theVariantsByPdgId[pdgId].push_back(index);
+            theVariants.push_back(variant);
+        }
+        theNParticles.push_back(theVariants.back().nodes.size());
+    }
+}
+
+// matching //
+bool GenDecayMatcher::accepts(const Node& node, int pdgId){
+    if( node.hadronClass!=NoClass ) return inHadronClass(node.hadronClass, pdgId);
+    for(int id : node.pdgIds){ if( id==pdgId ) return true; }
+    return false;
+}
+
+bool GenDecayMatcher::matchNode(const std::vector<Node>& nodes, unsigned node, unsigned particle,
+                                const GenEventIndex& genEventIndex, unsigned* result){
+    const Node& n = nodes[node];
+    if( !accepts(n, genEventIndex.particle(particle).pdgId()) ) return false;
+    result[node] = particle;
+    if( !n.decays ) return true;
+    GenEventIndex::IndexRange daughters = genEventIndex.daughters(particle);
+    if( n.inclusive ? (daughters.size() < n.nDaughters) : (daughters.size()!=n.nDaughters) ) return false;
+    return matchDaughters(nodes, node, 0, daughters, genEventIndex, result);
+}
+
+bool GenDecayMatcher::matchDaughters(const std::vector<Node>& nodes, unsigned node, unsigned daughter,
+                                     GenEventIndex::IndexRange daughters,
+                                     const GenEventIndex& genEventIndex, unsigned* result){
+    // assign the daughters of a node one by one to distinct daughter particles,
+    // trying all remaining particles for each of them
+    // (note: the number of daughters is small, so no need for anything smarter)
+    const Node& n = nodes[node];
+    if( daughter==n.nDaughters ) return true;
+    for(unsigned particle : daughters){
+        bool used = false;
+        for(unsigned j=0; j < daughter; j++){ if( result[n.firstDaughter+j]==particle ) used = true; }
+        if( used ) continue;
+        if( matchNode(nodes, n.firstDaughter+daughter, particle, genEventIndex, result)
+            && matchDaughters(nodes, node, daughter+1, daughters, genEventIndex, result) ) return true;
+    }
+    return false;
+}
+
+void GenDecayMatcher::match(const GenEventIndex& genEventIndex,
+                            const std::vector<unsigned>& mothers,
+                            Matches& matches) const {
+    // initialize the output
+    matches.theNParticles = theNParticles;
+    matches.theParticles.resize(theDescriptors.size());
+    for(std::vector<unsigned>& particles : matches.theParticles) particles.clear();
+
+    // loop over candidate mothers and try only the descriptors with a corresponding mother
+    // (note: at most one match is kept per mother and descriptor, e.g. if both charge conjugates match)
+    std::vector<unsigned> matchedMother(theDescriptors.size(), UINT_MAX);
+    std::vector<unsigned> result;
+    auto tryVariant = [&](unsigned index, unsigned mother){
+        const Variant& variant = theVariants[index];
+        if( matchedMother[variant.descriptor]==mother ) return;
+        result.resize(variant.nodes.size());
+        if( !matchNode(variant.nodes, 0, mother, genEventIndex, result.data()) ) return;
+        std::vector<unsigned>& particles = matches.theParticles[variant.descriptor];
+        particles.insert(particles.end(), result.begin(), result.end());
+        matchedMother[variant.descriptor] = mother;
+    };
+    for(unsigned mother : mothers){
+        auto it = theVariantsByPdgId.find(genEventIndex.particle(mother).pdgId());
+        if( it!=theVariantsByPdgId.end() ){
+            for(unsigned index : it->second) tryVariant(index, mother);
+        }
+        for(unsigned index : theClassVariants) tryVariant(index, mother);
+    }
+}
+
+int GenDecayMatcher::Matches::first() const {
+    for(unsigned i=0; i < theParticles.size(); i++){
+        if( theParticles[i].size()>0 ) return i;
+    }
+    return -1;
+}
@@ -0,0 +1,48 @@
+/*
+Custom producer class for indexing the gen particle record.
+
+The mother chains, daughters and hard scattering particles of the gen particles
+are found once per event and stored in a GenEventIndex product,
+which is shared by all gen-level producers and by the gen-matching of the charmed meson producers.
+*/
+
+// local include files
+#include "PhysicsTools/HcNano/interface/GenEventIndexProducer.h"
+
+// constructor //
+GenEventIndexProducer::GenEventIndexProducer(const edm::ParameterSet& iConfig)
+  : genParticlesToken(consumes<std::vector<reco::GenParticle>>(
+        iConfig.getParameter<edm::InputTag>("genParticlesToken"))){
+    // declare products
+    produces<GenEventIndex>();
+}
+
+// destructor //
+GenEventIndexProducer::~GenEventIndexProducer(){}
+
+// descriptions //
+void GenEventIndexProducer::fillDescriptions(edm::ConfigurationDescriptions &descriptions){
+    edm::ParameterSetDescription desc;
+    desc.add<edm::InputTag>("genParticlesToken", edm::InputTag("genParticlesToken"));
+    descriptions.addWithDefaultLabel(desc);
+}
+
+// produce (main method) //
+void GenEventIndexProducer::produce(edm::StreamID, edm::Event& iEvent, const edm::EventSetup& iSetup) const {
+
+    // get gen particles
+    // (note: if they are not available, no index is put in the event,
+    //  and the consumers handle the invalid product as they did for the gen particles)
+    edm::Handle<std::vector<reco::GenParticle>> genParticles;
+    iEvent.getByToken(genParticlesToken, genParticles);
+    if(!genParticles.isValid()){
+        std::cout << "WARNING: genParticle collection not valid" << std::endl;
+        return;
+    }
+
+    // index the gen particles and add the index to the event
+    iEvent.put(std::make_unique<GenEventIndex>(*genParticles));
+}
+
+// define this as a plug-in
+DEFINE_FWK_MODULE(GenEventIndexProducer);
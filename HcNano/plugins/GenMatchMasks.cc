@@ -0,0 +1,35 @@
+/*
+Per-event gen-match bitmasks of the selected tracks.
+*/
+
+// data format include files
+#include "DataFormats/Math/interface/deltaR.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/GenMatchMasks.h"
+
+// reset //
+void GenMatchMasks::reset(const SelectedTracks& tracks,
+                          unsigned nChains, unsigned nRoles, unsigned nFlags,
+                          double deltaR){
+    theTracks = &tracks;
+    theNRoles = nRoles;
+    theNFlags = nFlags;
+    theNWords = (nChains + wordSize - 1)/wordSize;
+    theDeltaR = deltaR;
+    theMasks.assign(tracks.size()*theNRoles*theNWords, 0);
+    theFlags.assign(theNFlags*theNWords, 0);
+}
+
+// gen particles //
+void GenMatchMasks::setParticle(unsigned chain, unsigned role, const reco::GenParticle& particle){
+    // (note: only the tracks in the neighbouring cells of the eta-phi grid are checked)
+    const TrackKinematics& kinematics = theTracks->kinematics();
+    theTracks->grid().neighbours(particle.eta(), particle.phi(), theDeltaR, theNeighbours);
+    const Word bit = Word(1) << (chain%wordSize);
+    for(unsigned track : theNeighbours){
+        double deltaR = reco::deltaR(kinematics.eta(track), kinematics.phi(track), particle.eta(), particle.phi());
+        if( deltaR >= theDeltaR ) continue;
+        theMasks[(track*theNRoles + role)*theNWords + chain/wordSize] |= bit;
+    }
+}
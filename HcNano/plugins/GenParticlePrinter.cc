@@ -10,8 +10,8 @@ For testing and debugging, not meant to be used in production.
 // constructor //
 GenParticlePrinter::GenParticlePrinter(const edm::ParameterSet& iConfig)
   : name(iConfig.getParameter<std::string>("name")),
-    genParticlesToken(consumes<reco::GenParticleCollection>(
-        iConfig.getParameter<edm::InputTag>("genParticlesToken"))) {
+    genEventIndexToken(consumes<GenEventIndex>(
+        iConfig.getParameter<edm::InputTag>("genEventIndexToken"))) {
     // declare tables to be produced
     // (none since this analyzer only prints some info,
     // does not produce any output).
@@ -26,27 +26,28 @@ GenParticlePrinter::~GenParticlePrinter(){}
 void GenParticlePrinter::fillDescriptions(edm::ConfigurationDescriptions &descriptions){
     edm::ParameterSetDescription desc;
     desc.add<std::string>("name", "Name for output table");
-    desc.add<edm::InputTag>("genParticlesToken", edm::InputTag("genParticlesToken"));
+    desc.add<edm::InputTag>("genEventIndexToken", edm::InputTag("genEventIndexToken"));
     descriptions.addWithDefaultLabel(desc);
 }
 
 // produce (main method) //
 void GenParticlePrinter::produce(edm::Event& iEvent, const edm::EventSetup& iSetup){
 
-    // get gen particles
-    edm::Handle<std::vector<reco::GenParticle>> genParticles;
-    iEvent.getByToken(genParticlesToken, genParticles);
-    if(!genParticles.isValid()){
-        std::cout << "WARNING: genParticle collection not valid" << std::endl;
+    // get the index of the gen particles
+    edm::Handle<GenEventIndex> genEventIndex;
+    iEvent.getByToken(genEventIndexToken, genEventIndex);
+    if(!genEventIndex.isValid()){
+        std::cout << "WARNING: gen event index not valid" << std::endl;
         return;
     }
+    const std::vector<reco::GenParticle>& genParticles = genEventIndex->particles();
 
     // print a few relevant gen particles in the event
-    for( const reco::GenParticle& p : *genParticles ){
-        if(!p.isLastCopy()) continue;
+    for( unsigned idx : genEventIndex->lastCopies() ){
+        const reco::GenParticle& p = genParticles[idx];
         int pdgid = p.pdgId();
         if(std::abs(pdgid) < 400 || std::abs(pdgid) > 500) continue;
-        int mompdgid = GenTools::getMotherPdgId(p, *genParticles);
+        int mompdgid = genEventIndex->motherPdgId(idx);
         std::cout << "Particle " << pdgid << std::endl;
         std::cout << "  kinematics: " << p.pt() << " " << p.eta() << " " << p.phi() << std::endl;
         std::cout << "  mass: " << p.mass() << std::endl;
@@ -35,23 +35,25 @@ int GenTools::getMotherPdgId(
     return mom->pdgId();
 }
 
-std::vector<reco::GenParticle> GenTools::getQuarkDaughters(
+std::vector<const reco::GenParticle*> GenTools::getQuarkDaughters(
         const reco::GenParticle& quark,
         const std::vector<reco::GenParticle>& genParticles){
-    std::vector<reco::GenParticle> res;
+    // (note: the daughters are returned as pointers into the gen particle collection,
+    //  so they can be stored in decay chains without copying them)
+    std::vector<const reco::GenParticle*> res;
     int quarkPdgId = quark.pdgId();
     
     // loop over daughters
     for(unsigned int i=0; i < quark.numberOfDaughters(); ++i){
-        const reco::GenParticle daughter = genParticles[quark.daughterRef(i).key()];
-        int daughterPdgId = daughter.pdgId();
+        const reco::GenParticle* daughter = &genParticles[quark.daughterRef(i).key()];
+        int daughterPdgId = daughter->pdgId();
         
         // if original quark is not last copy,
         // only look for the next copy and go recursively
         // (skipping all potential other daughters)
         if( !quark.isLastCopy() ){
             if( daughterPdgId != quarkPdgId ) continue;
-            for(const reco::GenParticle& d : getQuarkDaughters(daughter, genParticles)){
+            for(const reco::GenParticle* d : getQuarkDaughters(*daughter, genParticles)){
                 res.push_back(d);
             }
         }
@@ -61,9 +63,9 @@ std::vector<reco::GenParticle> GenTools::getQuarkDaughters(
         // so need to add an extra check to skip them explicitly.
         else{
             bool duplicate = false;
-            for(const reco::GenParticle& check : res){
-                if( daughter.pdgId()==check.pdgId()
-                    && GenTools::isGeometricGenParticleMatch(daughter, check, 0.05) ){
+            for(const reco::GenParticle* check : res){
+                if( daughter->pdgId()==check->pdgId()
+                    && GenTools::isGeometricGenParticleMatch(*daughter, *check, 0.05) ){
                     duplicate = true;
                 }
             }
@@ -73,7 +75,7 @@ std::vector<reco::GenParticle> GenTools::getQuarkDaughters(
     return res;
 }
 
-std::vector<reco::GenParticle> GenTools::getQuarkPairDaughters(
+std::vector<const reco::GenParticle*> GenTools::getQuarkPairDaughters(
         const reco::GenParticle& quark1,
         const reco::GenParticle& quark2,
         const std::vector<reco::GenParticle>& genParticles){
@@ -82,14 +84,11 @@ std::vector<reco::GenParticle> GenTools::getQuarkPairDaughters(
     // are stored for each of both quarks (and sometimes not),
     // so need to remove duplicates.
 
-    std::vector<reco::GenParticle> res;
-    for(const reco::GenParticle& d : getQuarkDaughters(quark1, genParticles)){
-        res.push_back(d);
-    }
-    for(const reco::GenParticle& d : getQuarkDaughters(quark2, genParticles)){
+    std::vector<const reco::GenParticle*> res = getQuarkDaughters(quark1, genParticles);
+    for(const reco::GenParticle* d : getQuarkDaughters(quark2, genParticles)){
         bool duplicate = false;
-        for(const reco::GenParticle& check : res){
-            if( d.pdgId()==check.pdgId() && GenTools::isGeometricGenParticleMatch(d, check, 0.05) ){
+        for(const reco::GenParticle* check : res){
+            if( d->pdgId()==check->pdgId() && GenTools::isGeometricGenParticleMatch(*d, *check, 0.05) ){
                 duplicate = true;
             }
         }
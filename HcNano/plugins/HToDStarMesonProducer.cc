@@ -12,51 +12,159 @@ D* -> D0 pi -> K pi pi
 HToDStarMesonProducer::HToDStarMesonProducer(const edm::ParameterSet& iConfig)
   : name(iConfig.getParameter<std::string>("name")),
     dtype(iConfig.getParameter<std::string>("dtype")),
-    packedPFCandidatesToken(consumes<std::vector<pat::PackedCandidate>>(
-        iConfig.getParameter<edm::InputTag>("packedPFCandidatesToken"))),
-    lostTracksToken(consumes<std::vector<pat::PackedCandidate>>(
-        iConfig.getParameter<edm::InputTag>("lostTracksToken"))),
-    genParticlesToken(consumes<std::vector<reco::GenParticle>>(
-        iConfig.getParameter<edm::InputTag>("genParticlesToken"))){
+    finderConfig(iConfig),
+    cutFlow(iConfig.getParameter<bool>("cutFlow")),
+    selectedTracksToken(consumes<SelectedTracks>(
+        iConfig.getParameter<edm::InputTag>("selectedTracksToken"))),
+    genEventIndexToken(consumes<GenEventIndex>(
+        iConfig.getParameter<edm::InputTag>("genEventIndexToken"))){
+    // consume the two-prong candidates if requested
+    const edm::InputTag twoProngCandidatesTag = iConfig.getParameter<edm::InputTag>("twoProngCandidatesToken");
+    useTwoProngCandidates = !twoProngCandidatesTag.label().empty();
+    if( useTwoProngCandidates ){
+        twoProngCandidatesToken = consumes<TwoProngCandidateCollection>(twoProngCandidatesTag);
+    }
     // declare tables to be produced
-    produces<nanoaod::FlatTable>(name);
+    produces<nanoaod::FlatTable>(name); // table of candidates
+    produces<nanoaod::FlatTable>(name+"Budget"); // singleton table of per-event budget flag and counters
+    if( cutFlow ){
+        // cut-flow counters per luminosity block
+        produces<nanoaod::MergeableCounterTable, edm::Transition::EndLuminosityBlock>(name+"CutFlow");
+    }
 }
 
 // destructor //
 HToDStarMesonProducer::~HToDStarMesonProducer(){}
 
+// beginning of stream //
+std::unique_ptr<ThreeProngCandidateFinder<HToDStarDecay>> HToDStarMesonProducer::beginStream(edm::StreamID) const {
+    return std::make_unique<ThreeProngCandidateFinder<HToDStarDecay>>(finderConfig);
+}
+
+// end of stream //
+void HToDStarMesonProducer::endStream(edm::StreamID id) const {
+    streamCache(id)->print(name);
+    std::lock_guard<std::mutex> lock(jobTimersMutex);
+    jobTimers.merge(streamCache(id)->timers());
+}
+
+// end of job //
+void HToDStarMesonProducer::endJob(){
+    jobTimers.print(name);
+}
+
+// luminosity blocks //
+// (note: the cut-flow counters of each stream are added to the ones of the luminosity block
+//  at the end of the luminosity block in that stream, and then reset)
+std::shared_ptr<CutFlow> HToDStarMesonProducer::globalBeginLuminosityBlockSummary(
+        const edm::LuminosityBlock&, const edm::EventSetup&) const {
+    return std::make_shared<CutFlow>();
+}
+
+void HToDStarMesonProducer::streamEndLuminosityBlockSummary(edm::StreamID id,
+        const edm::LuminosityBlock&, const edm::EventSetup&, CutFlow* lumiCutFlow) const {
+    CutFlow& streamCutFlow = streamCache(id)->cutFlow(0);
+    lumiCutFlow->add(streamCutFlow);
+    streamCutFlow.reset();
+}
+
+void HToDStarMesonProducer::globalEndLuminosityBlockSummary(
+        const edm::LuminosityBlock&, const edm::EventSetup&, CutFlow*) const {}
+
+void HToDStarMesonProducer::globalEndLuminosityBlockProduce(edm::LuminosityBlock& iLumi,
+        const edm::EventSetup&, const CutFlow* lumiCutFlow) const {
+    if( !cutFlow ) return;
+    iLumi.put(lumiCutFlow->makeTable(name+"CutFlow"), name+"CutFlow");
+}
+
 // descriptions //
 void HToDStarMesonProducer::fillDescriptions(edm::ConfigurationDescriptions &descriptions){
     edm::ParameterSetDescription desc;
     desc.add<std::string>("name", "Name for output table");
     desc.add<std::string>("dtype", "Data type (mc or data)");
-    desc.add<edm::InputTag>("packedPFCandidatesToken", edm::InputTag("packedPFCandidatesToken"));
-    desc.add<edm::InputTag>("lostTracksToken", edm::InputTag("lostTracksToken"));
-    desc.add<edm::InputTag>("genParticlesToken", edm::InputTag("genParticlesToken"));
+    ThreeProngCandidateFinder<HToDStarDecay>::fillDescriptions(desc);
+    desc.add<edm::InputTag>("selectedTracksToken", edm::InputTag("selectedTracksToken"));
+    desc.add<edm::InputTag>("genEventIndexToken", edm::InputTag("genEventIndexToken"));
+    desc.add<edm::InputTag>("twoProngCandidatesToken", edm::InputTag(""));
     descriptions.addWithDefaultLabel(desc);
 }
 
 // produce (main method) //
-void HToDStarMesonProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup){
+void HToDStarMesonProducer::produce(edm::StreamID id, edm::Event& iEvent, const edm::EventSetup& iSetup) const {
+
+    // candidate finder of this stream
+    ThreeProngCandidateFinder<HToDStarDecay>& candidateFinder = *streamCache(id);
 
     // get all required objects from tokens
-    edm::Handle<std::vector<pat::PackedCandidate>> packedPFCandidates;
-    iEvent.getByToken(packedPFCandidatesToken, packedPFCandidates);
-    edm::Handle<std::vector<pat::PackedCandidate>> lostTracks;
-    iEvent.getByToken(lostTracksToken, lostTracks);
-    MagneticField* bfield = new OAEParametrizedMagneticField("3_8T");
+    edm::Handle<SelectedTracks> selectedTracksHandle;
+    iEvent.getByToken(selectedTracksToken, selectedTracksHandle);
+    edm::Handle<GenEventIndex> genEventIndexHandle;
+    iEvent.getByToken(genEventIndexToken, genEventIndexHandle);
+
+    // settings for gen-matching
+    const GenEventIndex* genEventIndex = nullptr;
+    if( dtype=="mc" && genEventIndexHandle.isValid() ) genEventIndex = genEventIndexHandle.product();
+
+    // find the candidates
+    // (note: the track pairing, the vertex fits and the selection are done
+    //  by the three-prong candidate finder, specialised for this decay channel.
+    //  merging of packed candidates and lost tracks and the track preselection
+    //  are done only once per event in the SelectedTrackProducer)
+    std::array<std::vector<ThreeProngCandidate>, 1> candidates;
+    if( useTwoProngCandidates ){
+        edm::Handle<TwoProngCandidateCollection> twoProngCandidatesHandle;
+        iEvent.getByToken(twoProngCandidatesToken, twoProngCandidatesHandle);
+        candidateFinder.find(*selectedTracksHandle, {twoProngCandidatesHandle.product()},
+                             {maxCandidates}, candidates);
+    } else candidateFinder.find(*selectedTracksHandle, iEvent.id(), {maxCandidates}, candidates);
+
+    // make the tables and add them to the output
+    // (note: if timing is enabled, the per-event cost is added to the budget table)
+    StageTimers& timers = candidateFinder.timers();
+    {
+        StageTimers::Scope timer = timers.scope(StageTimers::Tables);
+        iEvent.put(makeTable(name, candidates[0], *selectedTracksHandle, genEventIndex), name);
+    }
+    const EventBudget& budget = candidateFinder.budget();
+    timers.finish(selectedTracksHandle->size(), budget.nPairs(), budget.nFits());
+    std::unique_ptr<nanoaod::FlatTable> budgetTable = budget.makeTable(name+"Budget");
+    if( timers.enabled() ) timers.addColumns(*budgetTable);
+    iEvent.put(std::move(budgetTable), name+"Budget");
+}
+
+// make the output table //
+std::unique_ptr<nanoaod::FlatTable> HToDStarMesonProducer::makeTable(
+        const std::string& name,
+        const std::vector<ThreeProngCandidate>& candidates,
+        const SelectedTracks& selectedTracks,
+        const GenEventIndex* genEventIndex){
+
+    // matcher for the gen-level decay chains
+    // (note: compiled once, at the first call)
+    static const GenDecayMatcher genDecayMatcher({HToDStarGenDecay::descriptor});
 
     // settings for gen-matching
-    edm::Handle<std::vector<reco::GenParticle>> genParticles;
-    iEvent.getByToken(genParticlesToken, genParticles);
-    std::vector< std::map< std::string, const reco::GenParticle* > > HToDStarGenParticles;
-    bool doMatching = (dtype=="mc") ? true : false;
-    if( !genParticles.isValid() ) doMatching = false;
+    std::vector<HToDStarGenChain> HToDStarGenParticles;
+    bool doMatching = (genEventIndex!=nullptr);
     if( doMatching ){
-        HToDStarGenParticles = HToDStarMesonGenProducer::find_H_to_DStar_to_DZeroPi_to_KPiPi( *genParticles );
+        HToDStarMesonGenProducer::find_H_decays( *genEventIndex, genDecayMatcher, HToDStarGenParticles );
         if( HToDStarGenParticles.size()==0 ) doMatching = false;
     }
 
+    // find the selected tracks matching each gen particle once for all candidates
+    enum GenRole { Pi1Role, KRole, Pi2Role, nGenRoles };
+    GenMatchMasks genMatchMasks;
+    if( doMatching ){
+        double dRThreshold = 0.05;
+        genMatchMasks.reset( selectedTracks, HToDStarGenParticles.size(), nGenRoles, 0, dRThreshold );
+        for(unsigned chain=0; chain<HToDStarGenParticles.size(); chain++){
+            const HToDStarGenChain& genChain = HToDStarGenParticles[chain];
+            genMatchMasks.setParticle( chain, Pi1Role, *genChain[HToDStarGenDecay::Pi1] );
+            genMatchMasks.setParticle( chain, KRole, *genChain[HToDStarGenDecay::K] );
+            genMatchMasks.setParticle( chain, Pi2Role, *genChain[HToDStarGenDecay::Pi2] );
+        }
+    }
+
     // declare output variables
     std::vector<float> HToDStarMeson_mass;
     std::vector<float> HToDStarMeson_pt;
@@ -93,226 +201,73 @@ void HToDStarMesonProducer::produce(edm::Event& iEvent, const edm::EventSetup& i
     std::vector<bool> HToDStarMeson_hasFastPartialGenMatch;
     std::vector<bool> HToDStarMeson_hasFastAllOriginGenMatch;
 
-    // merge packed candidate tracks and lost tracks
-    std::vector<reco::Track> allTracks;
-    for(const pat::PackedCandidate& pc: *packedPFCandidates){
-        if(pc.hasTrackDetails()){
-            reco::Track track = *pc.bestTrack();
-            allTracks.push_back(track);
-        }
-    }
-
-    for(const pat::PackedCandidate& pc: *lostTracks){
-        if(pc.hasTrackDetails()){
-            reco::Track track = *pc.bestTrack();
-            allTracks.push_back(track);
+    // loop over candidates
+    for(const ThreeProngCandidate& candidate : candidates){
+
+        // retrieve the tracks and four-vectors of the candidate
+        const reco::Track& tr1 = selectedTracks.track(candidate.track1);
+        const reco::Track& tr2 = selectedTracks.track(candidate.track2);
+        const reco::Track& tr3 = selectedTracks.track(candidate.track3);
+        const reco::Track& KTrack = selectedTracks.track(candidate.daughter1Track);
+        const reco::Track& pi2Track = selectedTracks.track(candidate.daughter2Track);
+        const ROOT::Math::PtEtaPhiMVector& KP4 = candidate.daughter1P4;
+        const ROOT::Math::PtEtaPhiMVector& pi2P4 = candidate.daughter2P4;
+        const ROOT::Math::PtEtaPhiMVector& dzeroP4 = candidate.twoProngP4;
+        const ROOT::Math::PtEtaPhiMVector& pi1P4 = candidate.track3P4;
+        const ROOT::Math::PtEtaPhiMVector& dstarP4 = candidate.threeProngP4;
+
+        // set properties of the D* candidate
+        HToDStarMeson_mass.push_back( dstarP4.M() );
+        HToDStarMeson_pt.push_back( dstarP4.pt() );
+        HToDStarMeson_eta.push_back( dstarP4.eta() );
+        HToDStarMeson_phi.push_back( dstarP4.phi() );
+        HToDStarMeson_DZeroMeson_mass.push_back( dzeroP4.M() );
+        HToDStarMeson_DZeroMeson_pt.push_back( dzeroP4.pt() );
+        HToDStarMeson_DZeroMeson_eta.push_back( dzeroP4.eta() );
+        HToDStarMeson_DZeroMeson_phi.push_back( dzeroP4.phi() );
+        HToDStarMeson_DZeroMeson_massDiff.push_back( dstarP4.M() - dzeroP4.M() );
+        HToDStarMeson_Pi1_pt.push_back( pi1P4.pt() );
+        HToDStarMeson_Pi1_eta.push_back( pi1P4.eta() );
+        HToDStarMeson_Pi1_phi.push_back( pi1P4.phi() );
+        HToDStarMeson_Pi1_charge.push_back( tr3.charge() );
+        HToDStarMeson_K_pt.push_back( KP4.pt() );
+        HToDStarMeson_K_eta.push_back( KP4.eta() );
+        HToDStarMeson_K_phi.push_back( KP4.phi() );
+        HToDStarMeson_K_charge.push_back( KTrack.charge() );
+        HToDStarMeson_Pi2_pt.push_back( pi2P4.pt() );
+        HToDStarMeson_Pi2_eta.push_back( pi2P4.eta() );
+        HToDStarMeson_Pi2_phi.push_back( pi2P4.phi() );
+        HToDStarMeson_Pi2_charge.push_back( pi2Track.charge() );
+        HToDStarMeson_tr1tr2_deltaR.push_back( reco::deltaR(tr1, tr2) );
+        HToDStarMeson_tr3d0_deltaR.push_back( reco::deltaR(tr3, dzeroP4) );
+        HToDStarMeson_d0vtx_normchi2.push_back( candidate.twoProngNormChi2 );
+        HToDStarMeson_dstarvtx_normchi2.push_back( candidate.threeProngNormChi2 );
+        HToDStarMeson_tr1tr2_sepx.push_back( candidate.twoTrackSepX );
+        HToDStarMeson_tr1tr2_sepy.push_back( candidate.twoTrackSepY );
+        HToDStarMeson_tr1tr2_sepz.push_back( candidate.twoTrackSepZ );
+        HToDStarMeson_tr3d0_sepx.push_back( candidate.thirdTrackSepX );
+        HToDStarMeson_tr3d0_sepy.push_back( candidate.thirdTrackSepY );
+        HToDStarMeson_tr3d0_sepz.push_back( candidate.thirdTrackSepZ );            
+
+        // check if this candidate can be matched to gen-level
+        bool hasFastGenMatch = false;
+        bool hasFastPartialGenMatch = false;
+        if( doMatching ){
+            const unsigned t3 = candidate.track3;
+            const unsigned pos = candidate.posTrack;
+            const unsigned neg = candidate.negTrack;
+            hasFastGenMatch = genMatchMasks.any( [&](const GenMatchMasks::View& m){
+                return m.mask(t3, Pi1Role)
+                       & ( (m.mask(pos, KRole) & m.mask(neg, Pi2Role))
+                           | (m.mask(pos, Pi2Role) & m.mask(neg, KRole)) ); } );
+            hasFastPartialGenMatch = genMatchMasks.any( [&](const GenMatchMasks::View& m){
+                return m.mask(t3, Pi1Role)
+                       | m.mask(pos, KRole) | m.mask(neg, Pi2Role)
+                       | m.mask(pos, Pi2Role) | m.mask(neg, KRole); } );
         }
-    }
-
-    // preselect tracks
-    std::vector<reco::Track> selectedTracks;
-    for(const reco::Track& track: allTracks){
-        if(!track.quality(reco::TrackBase::qualityByName("highPurity"))) continue;
-        if(track.pt() < 0.3) continue;
-	    selectedTracks.push_back(track);
-    }
-
-    // loop over pairs of tracks
-    for(unsigned i=0; i<selectedTracks.size(); i++){
-      for(unsigned j=i+1; j<selectedTracks.size(); j++){
-        const reco::Track tr1 = selectedTracks.at(i);
-        const reco::Track tr2 = selectedTracks.at(j);
-
-        // candidates must have opposite charge
-        // note: now disabled for study to check if candidates with same charge
-        //       can be used for background estimation.
-        //if(tr1.charge() * tr2.charge() > 0) continue;
-
-        // candidates must point approximately in the same direction
-        if( reco::deltaR(tr1, tr2) > 0.4 ) continue;
-
-        // reference points of both tracks must be close together
-        const math::XYZPoint tr1refpoint = tr1.referencePoint();
-        const math::XYZPoint tr2refpoint = tr2.referencePoint();
-        double twotracksepx = std::abs(tr1refpoint.x()-tr2refpoint.x());
-        double twotracksepy = std::abs(tr1refpoint.y()-tr2refpoint.y());
-        double twotracksepz = std::abs(tr1refpoint.z()-tr2refpoint.z());
-        if( twotracksepx>0.02 || twotracksepy>0.02 || twotracksepz>0.05 ) continue;
-       
-        // find which track is positive and which is negative
-        reco::Track postrack;
-        reco::Track negtrack;
-        if(tr1.charge()>0. and tr2.charge()<0){
-            postrack = tr1;
-            negtrack = tr2;
-        } else if(tr1.charge()<0. and tr2.charge()>0){
-	        postrack = tr2;
-	        negtrack = tr1;
-        } else {
-            // if both tracks have the same charge
-            // (e.g. in combinatorial background),
-            // assign them randomly.
-            if( rand() % 2 == 0 ){
-                postrack = tr1;
-                negtrack = tr2;
-            } else {
-                postrack = tr2;
-                negtrack = tr1;
-            }
-        }
-
-        // make invariant mass
-        // (note: although the D0 meson decays preferentially to K- pi+ rather than K+ pi-,
-        //  still both possibilities must be considered since the original particle could
-        //  be an anti-D0, which decays preferentially to K+ pi-)
-        ROOT::Math::PtEtaPhiMVector piPlusP4(postrack.pt(), postrack.eta(), postrack.phi(), pimass);
-        ROOT::Math::PtEtaPhiMVector KMinusP4(negtrack.pt(), negtrack.eta(), negtrack.phi(), kmass);
-        ROOT::Math::PtEtaPhiMVector KPlusP4(postrack.pt(), postrack.eta(), postrack.phi(), kmass);
-        ROOT::Math::PtEtaPhiMVector piMinusP4(negtrack.pt(), negtrack.eta(), negtrack.phi(), pimass);
-        ROOT::Math::PtEtaPhiMVector dzeroP4 = piPlusP4 + KMinusP4;
-        ROOT::Math::PtEtaPhiMVector dzerobarP4 = piMinusP4 + KPlusP4;
-        double dzeroInvMass = dzeroP4.M();
-        double dzerobarInvMass = dzerobarP4.M();
-        
-        // invariant mass must be close to resonance mass
-        ROOT::Math::PtEtaPhiMVector pi2P4(0, 0, 0, 0);
-        ROOT::Math::PtEtaPhiMVector KP4(0, 0, 0, 0);
-        reco::Track pi2Track;
-        reco::Track KTrack;
-        if( (std::abs(dzeroInvMass - dzeromass) < 0.035)
-            && (std::abs(dzeroInvMass - dzeromass) < std::abs(dzerobarInvMass - dzeromass)) ){
-            pi2P4 = piPlusP4;
-            KP4 = KMinusP4;
-            pi2Track = postrack;
-            KTrack = negtrack;
-        } else if( (std::abs(dzerobarInvMass - dzeromass) < 0.035) 
-                   && (std::abs(dzerobarInvMass - dzeromass) < std::abs(dzeroInvMass - dzeromass)) ){
-            pi2P4 = piMinusP4;
-            KP4 = KPlusP4;
-            pi2Track = negtrack;
-            KTrack = postrack;
-            dzeroP4 = dzerobarP4;
-            dzeroInvMass = dzerobarInvMass;
-        } else continue;
-
-        // K candidate must have a given minimum pt
-        if( KP4.pt() < 1. ) continue;
-
-        // fit a vertex
-        std::vector<reco::TransientTrack> transpair;
-        transpair.push_back(reco::TransientTrack(tr1, bfield));
-        transpair.push_back(reco::TransientTrack(tr2, bfield));
-        KalmanVertexFitter vtxFitter(false);
-        TransientVertex dzerovtx = vtxFitter.vertex(transpair);
-        // vertex must be valid
-        if(!dzerovtx.isValid()) continue;
-        // chi squared of fit must be small
-        if(dzerovtx.normalisedChiSquared()>5.) continue;
-        if(dzerovtx.normalisedChiSquared()<0.) continue;
-        
-        // loop over third track
-	    for(unsigned k=0; k<selectedTracks.size(); k++){
-            if(k==i or k==j) continue;
-            const reco::Track tr3 = selectedTracks.at(k);
-
-            // pi candidate must have a given minimum pt
-            if( tr3.pt() < 0.5 ) continue;
-
-            // candidates must point approximately in the same direction
-            if( reco::deltaR(tr3, dzeroP4) > 0.1 ) continue;
-
-            // reference point of third track must be close to phi vertex
-            const math::XYZPoint tr3refpoint = tr3.referencePoint();
-            double trackvtxsepx = std::abs(tr3refpoint.x()-dzerovtx.position().x());
-            double trackvtxsepy = std::abs(tr3refpoint.y()-dzerovtx.position().y());
-            double trackvtxsepz = std::abs(tr3refpoint.z()-dzerovtx.position().z());
-            if( trackvtxsepx>0.1 || trackvtxsepy>0.1 || trackvtxsepz>0.1 ) continue;
-
-            // make invariant mass (under the assumption of pi mass for the third track)
-            ROOT::Math::PtEtaPhiMVector pi1P4(tr3.pt(), tr3.eta(), tr3.phi(), pimass);
-            ROOT::Math::PtEtaPhiMVector dstarP4 = dzeroP4 + pi1P4;
-            double dstarInvMass = dstarP4.M();
-
-            // check if mass is close enough to D* mass
-            if(std::abs(dstarInvMass - dstarmass) > 0.1) continue;
-
-            // do a vertex fit
-            std::vector<reco::TransientTrack> transtriplet;
-            transtriplet.push_back(reco::TransientTrack(tr1, bfield));
-            transtriplet.push_back(reco::TransientTrack(tr2, bfield));
-            transtriplet.push_back(reco::TransientTrack(tr3, bfield));
-            TransientVertex dstarvtx = vtxFitter.vertex(transtriplet);
-            if(!dstarvtx.isValid()) continue;
-            if(dstarvtx.normalisedChiSquared()>5.) continue;
-            if(dstarvtx.normalisedChiSquared()<0.) continue;
-
-            // set properties of the D* candidate
-            HToDStarMeson_mass.push_back( dstarP4.M() );
-            HToDStarMeson_pt.push_back( dstarP4.pt() );
-            HToDStarMeson_eta.push_back( dstarP4.eta() );
-            HToDStarMeson_phi.push_back( dstarP4.phi() );
-            HToDStarMeson_DZeroMeson_mass.push_back( dzeroP4.M() );
-            HToDStarMeson_DZeroMeson_pt.push_back( dzeroP4.pt() );
-            HToDStarMeson_DZeroMeson_eta.push_back( dzeroP4.eta() );
-            HToDStarMeson_DZeroMeson_phi.push_back( dzeroP4.phi() );
-            HToDStarMeson_DZeroMeson_massDiff.push_back( dstarP4.M() - dzeroP4.M() );
-            HToDStarMeson_Pi1_pt.push_back( pi1P4.pt() );
-            HToDStarMeson_Pi1_eta.push_back( pi1P4.eta() );
-            HToDStarMeson_Pi1_phi.push_back( pi1P4.phi() );
-            HToDStarMeson_Pi1_charge.push_back( tr3.charge() );
-            HToDStarMeson_K_pt.push_back( KP4.pt() );
-            HToDStarMeson_K_eta.push_back( KP4.eta() );
-            HToDStarMeson_K_phi.push_back( KP4.phi() );
-            HToDStarMeson_K_charge.push_back( KTrack.charge() );
-            HToDStarMeson_Pi2_pt.push_back( pi2P4.pt() );
-            HToDStarMeson_Pi2_eta.push_back( pi2P4.eta() );
-            HToDStarMeson_Pi2_phi.push_back( pi2P4.phi() );
-            HToDStarMeson_Pi2_charge.push_back( pi2Track.charge() );
-            HToDStarMeson_tr1tr2_deltaR.push_back( reco::deltaR(tr1, tr2) );
-            HToDStarMeson_tr3d0_deltaR.push_back( reco::deltaR(tr3, dzeroP4) );
-            HToDStarMeson_d0vtx_normchi2.push_back( dzerovtx.normalisedChiSquared() );
-            HToDStarMeson_dstarvtx_normchi2.push_back( dstarvtx.normalisedChiSquared() );
-            HToDStarMeson_tr1tr2_sepx.push_back( twotracksepx );
-            HToDStarMeson_tr1tr2_sepy.push_back( twotracksepy );
-            HToDStarMeson_tr1tr2_sepz.push_back( twotracksepz );
-            HToDStarMeson_tr3d0_sepx.push_back( trackvtxsepx );
-            HToDStarMeson_tr3d0_sepy.push_back( trackvtxsepy );
-            HToDStarMeson_tr3d0_sepz.push_back( trackvtxsepz );            
-
-            // check if this candidate can be matched to gen-level
-            bool hasFastGenMatch = false;
-            bool hasFastPartialGenMatch = false;
-            if( doMatching ){
-                for( const auto& pmap : HToDStarGenParticles){
-                    double dRThreshold = 0.05;
-                    if( GenTools::isGeometricTrackMatch( tr3, *pmap.at("Pi1"), dRThreshold )
-                        && ( (GenTools::isGeometricTrackMatch( postrack, *pmap.at("K"), dRThreshold )
-                              && GenTools::isGeometricTrackMatch( negtrack, *pmap.at("Pi2"), dRThreshold ) )
-                             || (GenTools::isGeometricTrackMatch( postrack, *pmap.at("Pi2"), dRThreshold )
-                              && GenTools::isGeometricTrackMatch( negtrack, *pmap.at("K"), dRThreshold ) ) ) ){
-                        hasFastGenMatch = true;
-                    }
-                    if( GenTools::isGeometricTrackMatch( tr3, *pmap.at("Pi1"), dRThreshold )
-                         || GenTools::isGeometricTrackMatch( postrack, *pmap.at("K"), dRThreshold )
-                         || GenTools::isGeometricTrackMatch( negtrack, *pmap.at("Pi2"), dRThreshold )
-                         || GenTools::isGeometricTrackMatch( postrack, *pmap.at("Pi2"), dRThreshold )
-                         || GenTools::isGeometricTrackMatch( negtrack, *pmap.at("K"), dRThreshold ) ){
-                        hasFastPartialGenMatch = true;
-                    }
-                }
-            }
-            HToDStarMeson_hasFastGenMatch.push_back( hasFastGenMatch );
-            HToDStarMeson_hasFastPartialGenMatch.push_back( hasFastPartialGenMatch );
-
-            // break loop over third track in case maximum number was reached
-            if( HToDStarMeson_mass.size() == nHToDStarMeson_max ) break;
-
-        } // end loop over third track
-        if( HToDStarMeson_mass.size() == nHToDStarMeson_max ) break;
-      }
-      if( HToDStarMeson_mass.size()  == nHToDStarMeson_max) break;
-    } // end loop over first and second track
-    delete bfield;
+        HToDStarMeson_hasFastGenMatch.push_back( hasFastGenMatch );
+        HToDStarMeson_hasFastPartialGenMatch.push_back( hasFastPartialGenMatch );
+    } // end loop over candidates
 
     // make the table
     auto table = std::make_unique<nanoaod::FlatTable>(HToDStarMeson_mass.size(), name, false);
@@ -350,8 +305,7 @@ void HToDStarMesonProducer::produce(edm::Event& iEvent, const edm::EventSetup& i
     table->addColumn<bool>("hasFastGenmatch", HToDStarMeson_hasFastGenMatch, "");
     table->addColumn<bool>("hasFastPartialGenmatch", HToDStarMeson_hasFastPartialGenMatch, "");
 
-    // add the table to the output
-    iEvent.put(std::move(table), name);
+    return table;
 }
 
 // define this as a plug-in
@@ -12,51 +12,159 @@ Ds -> phi pi -> K K pi
 HToDsMesonProducer::HToDsMesonProducer(const edm::ParameterSet& iConfig)
   : name(iConfig.getParameter<std::string>("name")),
     dtype(iConfig.getParameter<std::string>("dtype")),
-    packedPFCandidatesToken(consumes<std::vector<pat::PackedCandidate>>(
-        iConfig.getParameter<edm::InputTag>("packedPFCandidatesToken"))),
-    lostTracksToken(consumes<std::vector<pat::PackedCandidate>>(
-        iConfig.getParameter<edm::InputTag>("lostTracksToken"))),
-    genParticlesToken(consumes<std::vector<reco::GenParticle>>(
-        iConfig.getParameter<edm::InputTag>("genParticlesToken"))){
+    finderConfig(iConfig),
+    cutFlow(iConfig.getParameter<bool>("cutFlow")),
+    selectedTracksToken(consumes<SelectedTracks>(
+        iConfig.getParameter<edm::InputTag>("selectedTracksToken"))),
+    genEventIndexToken(consumes<GenEventIndex>(
+        iConfig.getParameter<edm::InputTag>("genEventIndexToken"))){
+    // consume the two-prong candidates if requested
+    const edm::InputTag twoProngCandidatesTag = iConfig.getParameter<edm::InputTag>("twoProngCandidatesToken");
+    useTwoProngCandidates = !twoProngCandidatesTag.label().empty();
+    if( useTwoProngCandidates ){
+        twoProngCandidatesToken = consumes<TwoProngCandidateCollection>(twoProngCandidatesTag);
+    }
     // declare tables to be produced
-    produces<nanoaod::FlatTable>(name);
+    produces<nanoaod::FlatTable>(name); // table of candidates
+    produces<nanoaod::FlatTable>(name+"Budget"); // singleton table of per-event budget flag and counters
+    if( cutFlow ){
+        // cut-flow counters per luminosity block
+        produces<nanoaod::MergeableCounterTable, edm::Transition::EndLuminosityBlock>(name+"CutFlow");
+    }
 }
 
 // destructor //
 HToDsMesonProducer::~HToDsMesonProducer(){}
 
+// beginning of stream //
+std::unique_ptr<ThreeProngCandidateFinder<HToDsDecay>> HToDsMesonProducer::beginStream(edm::StreamID) const {
+    return std::make_unique<ThreeProngCandidateFinder<HToDsDecay>>(finderConfig);
+}
+
+// end of stream //
+void HToDsMesonProducer::endStream(edm::StreamID id) const {
+    streamCache(id)->print(name);
+    std::lock_guard<std::mutex> lock(jobTimersMutex);
+    jobTimers.merge(streamCache(id)->timers());
+}
+
+// end of job //
+void HToDsMesonProducer::endJob(){
+    jobTimers.print(name);
+}
+
+// luminosity blocks //
+// (note: the cut-flow counters of each stream are added to the ones of the luminosity block
+//  at the end of the luminosity block in that stream, and then reset)
+std::shared_ptr<CutFlow> HToDsMesonProducer::globalBeginLuminosityBlockSummary(
+        const edm::LuminosityBlock&, const edm::EventSetup&) const {
+    return std::make_shared<CutFlow>();
+}
+
+void HToDsMesonProducer::streamEndLuminosityBlockSummary(edm::StreamID id,
+        const edm::LuminosityBlock&, const edm::EventSetup&, CutFlow* lumiCutFlow) const {
+    CutFlow& streamCutFlow = streamCache(id)->cutFlow(0);
+    lumiCutFlow->add(streamCutFlow);
+    streamCutFlow.reset();
+}
+
+void HToDsMesonProducer::globalEndLuminosityBlockSummary(
+        const edm::LuminosityBlock&, const edm::EventSetup&, CutFlow*) const {}
+
+void HToDsMesonProducer::globalEndLuminosityBlockProduce(edm::LuminosityBlock& iLumi,
+        const edm::EventSetup&, const CutFlow* lumiCutFlow) const {
+    if( !cutFlow ) return;
+    iLumi.put(lumiCutFlow->makeTable(name+"CutFlow"), name+"CutFlow");
+}
+
 // descriptions //
 void HToDsMesonProducer::fillDescriptions(edm::ConfigurationDescriptions &descriptions){
     edm::ParameterSetDescription desc;
     desc.add<std::string>("name", "Name for output table");
     desc.add<std::string>("dtype", "Data type (mc or data)");
-    desc.add<edm::InputTag>("packedPFCandidatesToken", edm::InputTag("packedPFCandidatesToken"));
-    desc.add<edm::InputTag>("lostTracksToken", edm::InputTag("lostTracksToken"));
-    desc.add<edm::InputTag>("genParticlesToken", edm::InputTag("genParticlesToken"));
+    ThreeProngCandidateFinder<HToDsDecay>::fillDescriptions(desc);
+    desc.add<edm::InputTag>("selectedTracksToken", edm::InputTag("selectedTracksToken"));
+    desc.add<edm::InputTag>("genEventIndexToken", edm::InputTag("genEventIndexToken"));
+    desc.add<edm::InputTag>("twoProngCandidatesToken", edm::InputTag(""));
     descriptions.addWithDefaultLabel(desc);
 }
 
 // produce (main method) //
-void HToDsMesonProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup){
+void HToDsMesonProducer::produce(edm::StreamID id, edm::Event& iEvent, const edm::EventSetup& iSetup) const {
+
+    // candidate finder of this stream
+    ThreeProngCandidateFinder<HToDsDecay>& candidateFinder = *streamCache(id);
 
     // get all required objects from tokens
-    edm::Handle<std::vector<pat::PackedCandidate>> packedPFCandidates;
-    iEvent.getByToken(packedPFCandidatesToken, packedPFCandidates);
-    edm::Handle<std::vector<pat::PackedCandidate>> lostTracks;
-    iEvent.getByToken(lostTracksToken, lostTracks);
-    MagneticField* bfield = new OAEParametrizedMagneticField("3_8T");
+    edm::Handle<SelectedTracks> selectedTracksHandle;
+    iEvent.getByToken(selectedTracksToken, selectedTracksHandle);
+    edm::Handle<GenEventIndex> genEventIndexHandle;
+    iEvent.getByToken(genEventIndexToken, genEventIndexHandle);
+
+    // settings for gen-matching
+    const GenEventIndex* genEventIndex = nullptr;
+    if( dtype=="mc" && genEventIndexHandle.isValid() ) genEventIndex = genEventIndexHandle.product();
+
+    // find the candidates
+    // (note: the track pairing, the vertex fits and the selection are done
+    //  by the three-prong candidate finder, specialised for this decay channel.
+    //  merging of packed candidates and lost tracks and the track preselection
+    //  are done only once per event in the SelectedTrackProducer)
+    std::array<std::vector<ThreeProngCandidate>, 1> candidates;
+    if( useTwoProngCandidates ){
+        edm::Handle<TwoProngCandidateCollection> twoProngCandidatesHandle;
+        iEvent.getByToken(twoProngCandidatesToken, twoProngCandidatesHandle);
+        candidateFinder.find(*selectedTracksHandle, {twoProngCandidatesHandle.product()},
+                             {maxCandidates}, candidates);
+    } else candidateFinder.find(*selectedTracksHandle, iEvent.id(), {maxCandidates}, candidates);
+
+    // make the tables and add them to the output
+    // (note: if timing is enabled, the per-event cost is added to the budget table)
+    StageTimers& timers = candidateFinder.timers();
+    {
+        StageTimers::Scope timer = timers.scope(StageTimers::Tables);
+        iEvent.put(makeTable(name, candidates[0], *selectedTracksHandle, genEventIndex), name);
+    }
+    const EventBudget& budget = candidateFinder.budget();
+    timers.finish(selectedTracksHandle->size(), budget.nPairs(), budget.nFits());
+    std::unique_ptr<nanoaod::FlatTable> budgetTable = budget.makeTable(name+"Budget");
+    if( timers.enabled() ) timers.addColumns(*budgetTable);
+    iEvent.put(std::move(budgetTable), name+"Budget");
+}
+
+// make the output table //
+std::unique_ptr<nanoaod::FlatTable> HToDsMesonProducer::makeTable(
+        const std::string& name,
+        const std::vector<ThreeProngCandidate>& candidates,
+        const SelectedTracks& selectedTracks,
+        const GenEventIndex* genEventIndex){
+
+    // matcher for the gen-level decay chains
+    // (note: compiled once, at the first call)
+    static const GenDecayMatcher genDecayMatcher({HToDsGenDecay::descriptor});
 
     // settings for gen-matching
-    edm::Handle<std::vector<reco::GenParticle>> genParticles;
-    iEvent.getByToken(genParticlesToken, genParticles);
-    std::vector< std::map< std::string, const reco::GenParticle* > > HToDsGenParticles;
-    bool doMatching = (dtype=="mc") ? true : false;
-    if( !genParticles.isValid() ) doMatching = false;
+    std::vector<HToDsGenChain> HToDsGenParticles;
+    bool doMatching = (genEventIndex!=nullptr);
     if( doMatching ){
-        HToDsGenParticles = HToDsMesonGenProducer::find_H_to_Ds_to_PhiPi_to_KKPi( *genParticles );
+        HToDsMesonGenProducer::find_H_decays( *genEventIndex, genDecayMatcher, HToDsGenParticles );
         if( HToDsGenParticles.size()==0 ) doMatching = false;
     }
 
+    // find the selected tracks matching each gen particle once for all candidates
+    enum GenRole { PiRole, KPlusRole, KMinusRole, nGenRoles };
+    GenMatchMasks genMatchMasks;
+    if( doMatching ){
+        double dRThreshold = 0.05;
+        genMatchMasks.reset( selectedTracks, HToDsGenParticles.size(), nGenRoles, 0, dRThreshold );
+        for(unsigned chain=0; chain<HToDsGenParticles.size(); chain++){
+            const HToDsGenChain& genChain = HToDsGenParticles[chain];
+            genMatchMasks.setParticle( chain, PiRole, *genChain[HToDsGenDecay::Pi] );
+            genMatchMasks.setParticle( chain, KPlusRole, *genChain[HToDsGenDecay::KPlus] );
+            genMatchMasks.setParticle( chain, KMinusRole, *genChain[HToDsGenDecay::KMinus] );
+        }
+    }
+
     // declare output variables
     std::vector<float> HToDsMeson_mass;
     std::vector<float> HToDsMeson_pt;
@@ -93,194 +201,69 @@ void HToDsMesonProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSet
     std::vector<bool> HToDsMeson_hasFastPartialGenMatch;
     std::vector<bool> HToDsMeson_hasFastAllOriginGenMatch;
 
-    // merge packed candidate tracks and lost tracks
-    std::vector<reco::Track> allTracks;
-    for(const pat::PackedCandidate& pc: *packedPFCandidates){
-        if(pc.hasTrackDetails()){
-            reco::Track track = *pc.bestTrack();
-            allTracks.push_back(track);
-        }
-    }
-
-    for(const pat::PackedCandidate& pc: *lostTracks){
-        if(pc.hasTrackDetails()){
-            reco::Track track = *pc.bestTrack();
-            allTracks.push_back(track);
-        }
-    }
-
-    // preselect tracks
-    std::vector<reco::Track> selectedTracks;
-    for(const reco::Track& track: allTracks){
-        if(!track.quality(reco::TrackBase::qualityByName("highPurity"))) continue;
-        if(track.pt() < 0.3) continue;
-	    selectedTracks.push_back(track);
-    }
-
-    // loop over pairs of tracks
-    for(unsigned i=0; i<selectedTracks.size(); i++){
-      for(unsigned j=i+1; j<selectedTracks.size(); j++){
-        const reco::Track tr1 = selectedTracks.at(i);
-        const reco::Track tr2 = selectedTracks.at(j);
+    // loop over candidates
+    for(const ThreeProngCandidate& candidate : candidates){
 
-        // candidates must have opposite charge
-        // note: now disabled for study to check if candidates with same charge
-        //       can be used for background estimation.
-        //if(tr1.charge() * tr2.charge() > 0) continue;
+        // retrieve the tracks and four-vectors of the candidate
+        const reco::Track& tr1 = selectedTracks.track(candidate.track1);
+        const reco::Track& tr2 = selectedTracks.track(candidate.track2);
+        const reco::Track& tr3 = selectedTracks.track(candidate.track3);
+        const reco::Track& postrack = selectedTracks.track(candidate.posTrack);
+        const reco::Track& negtrack = selectedTracks.track(candidate.negTrack);
+        const ROOT::Math::PtEtaPhiMVector& KPlusP4 = candidate.daughter1P4;
+        const ROOT::Math::PtEtaPhiMVector& KMinusP4 = candidate.daughter2P4;
+        const ROOT::Math::PtEtaPhiMVector& phiP4 = candidate.twoProngP4;
+        const ROOT::Math::PtEtaPhiMVector& piP4 = candidate.track3P4;
+        const ROOT::Math::PtEtaPhiMVector& dsP4 = candidate.threeProngP4;
 
-        // candidates must have a given minimum transverse momentum
-        if( tr1.pt() < 1. || tr2.pt() < 1. ) continue;
+        // set properties of the Ds candidate
+        HToDsMeson_mass.push_back( dsP4.M() );
+        HToDsMeson_pt.push_back( dsP4.pt() );
+        HToDsMeson_eta.push_back( dsP4.eta() );
+        HToDsMeson_phi.push_back( dsP4.phi() );
+        HToDsMeson_PhiMeson_mass.push_back( phiP4.M() );
+        HToDsMeson_PhiMeson_pt.push_back( phiP4.pt() );
+        HToDsMeson_PhiMeson_eta.push_back( phiP4.eta() );
+        HToDsMeson_PhiMeson_phi.push_back( phiP4.phi() );
+        HToDsMeson_PhiMeson_massDiff.push_back( dsP4.M() - phiP4.M() );
+        HToDsMeson_Pi_pt.push_back( piP4.pt() );
+        HToDsMeson_Pi_eta.push_back( piP4.eta() );
+        HToDsMeson_Pi_phi.push_back( piP4.phi() );
+        HToDsMeson_Pi_charge.push_back( tr3.charge() );
+        HToDsMeson_KPlus_pt.push_back( KPlusP4.pt() );
+        HToDsMeson_KPlus_eta.push_back( KPlusP4.eta() );
+        HToDsMeson_KPlus_phi.push_back( KPlusP4.phi() );
+        HToDsMeson_KPlus_charge.push_back( postrack.charge() );
+        HToDsMeson_KMinus_pt.push_back( KMinusP4.pt() );
+        HToDsMeson_KMinus_eta.push_back( KMinusP4.eta() );
+        HToDsMeson_KMinus_phi.push_back( KMinusP4.phi() );
+        HToDsMeson_KMinus_charge.push_back( negtrack.charge() );
+        HToDsMeson_tr1tr2_deltaR.push_back( reco::deltaR(tr1, tr2) );
+        HToDsMeson_tr3phi_deltaR.push_back( reco::deltaR(tr3, phiP4) );
+        HToDsMeson_phivtx_normchi2.push_back( candidate.twoProngNormChi2 );
+        HToDsMeson_dsvtx_normchi2.push_back( candidate.threeProngNormChi2 );
+        HToDsMeson_tr1tr2_sepx.push_back( candidate.twoTrackSepX );
+        HToDsMeson_tr1tr2_sepy.push_back( candidate.twoTrackSepY );
+        HToDsMeson_tr1tr2_sepz.push_back( candidate.twoTrackSepZ );
+        HToDsMeson_tr3phi_sepx.push_back( candidate.thirdTrackSepX );
+        HToDsMeson_tr3phi_sepy.push_back( candidate.thirdTrackSepY );
+        HToDsMeson_tr3phi_sepz.push_back( candidate.thirdTrackSepZ );
 
-        // candidates must point approximately in the same direction
-        if( reco::deltaR(tr1, tr2) > 0.2 ) continue;
-	
-        // reference points of both tracks must be close together
-        const math::XYZPoint tr1refpoint = tr1.referencePoint();
-        const math::XYZPoint tr2refpoint = tr2.referencePoint();
-        double twotracksepx = std::abs(tr1refpoint.x()-tr2refpoint.x());
-        double twotracksepy = std::abs(tr1refpoint.y()-tr2refpoint.y());
-        double twotracksepz = std::abs(tr1refpoint.z()-tr2refpoint.z());
-        if( twotracksepx>0.02 || twotracksepy>0.02 || twotracksepz>0.05 ) continue;
-       
-        // find which track is positive and which is negative
-        reco::Track postrack;
-        reco::Track negtrack;
-        if(tr1.charge()>0. and tr2.charge()<0){
-            postrack = tr1;
-            negtrack = tr2;
-        } else if(tr1.charge()<0. and tr2.charge()>0){
-	        postrack = tr2;
-	        negtrack = tr1;
-        } else {
-            // if both tracks have the same charge
-            // (e.g. in combinatorial background),
-            // assign them randomly.
-            if( rand() % 2 == 0 ){
-                postrack = tr1;
-                negtrack = tr2;
-            } else {
-                postrack = tr2;
-                negtrack = tr1;
-            }
+        // check if this candidate can be matched to gen-level
+        bool hasFastGenMatch = false;
+        bool hasFastPartialGenMatch = false;
+        if( doMatching ){
+            const unsigned t3 = candidate.track3;
+            const unsigned pos = candidate.posTrack;
+            const unsigned neg = candidate.negTrack;
+            hasFastGenMatch = genMatchMasks.any( [&](const GenMatchMasks::View& m){
+                return m.mask(t3, PiRole) & m.mask(pos, KPlusRole) & m.mask(neg, KMinusRole); } );
+            hasFastPartialGenMatch = genMatchMasks.any( [&](const GenMatchMasks::View& m){
+                return m.mask(t3, PiRole) | m.mask(pos, KPlusRole) | m.mask(neg, KMinusRole); } );
         }
-
-        // make invariant mass (under the assumption of K mass for both tracks)
-        ROOT::Math::PtEtaPhiMVector KPlusP4(postrack.pt(), postrack.eta(), postrack.phi(), kmass);
-        ROOT::Math::PtEtaPhiMVector KMinusP4(negtrack.pt(), negtrack.eta(), negtrack.phi(), kmass);
-        ROOT::Math::PtEtaPhiMVector phiP4 = KPlusP4 + KMinusP4;
-        double phiInvMass = phiP4.M();
-
-        // check if mass is close enough to phi mass
-        if(std::abs(phiInvMass - phimass) > 0.07) continue;
-
-        // fit a vertex
-        std::vector<reco::TransientTrack> transpair;
-        transpair.push_back(reco::TransientTrack(tr1, bfield));
-        transpair.push_back(reco::TransientTrack(tr2, bfield));
-        KalmanVertexFitter vtxFitter(false);
-        TransientVertex phivtx = vtxFitter.vertex(transpair);
-        // vertex must be valid
-        if(!phivtx.isValid()) continue;
-        // chi squared of fit must be small
-        if(phivtx.normalisedChiSquared()>5.) continue;
-        if(phivtx.normalisedChiSquared()<0.) continue;
-        
-        // loop over third track
-	    for(unsigned k=0; k<selectedTracks.size(); k++){
-            if(k==i or k==j) continue;
-            const reco::Track tr3 = selectedTracks.at(k);
-
-            // candidates must point approximately in the same direction
-            if( reco::deltaR(tr3, phiP4) > 0.4 ) continue;
-
-            // reference point of third track must be close to phi vertex
-            const math::XYZPoint tr3refpoint = tr3.referencePoint();
-            double trackvtxsepx = std::abs(tr3refpoint.x()-phivtx.position().x());
-            double trackvtxsepy = std::abs(tr3refpoint.y()-phivtx.position().y());
-            double trackvtxsepz = std::abs(tr3refpoint.z()-phivtx.position().z());
-            if( trackvtxsepx>0.1 || trackvtxsepy>0.1 || trackvtxsepz>0.1 ) continue;
-
-            // make invariant mass (under the assumption of pi mass for the third track)
-            ROOT::Math::PtEtaPhiMVector piP4(tr3.pt(), tr3.eta(), tr3.phi(), pimass);
-            ROOT::Math::PtEtaPhiMVector dsP4 = phiP4 + piP4;
-            double dsInvMass = dsP4.M();
-
-            // check if mass is close enough to Ds mass
-            if(std::abs(dsInvMass - dsmass) > 0.1) continue;
-
-            // do a vertex fit
-            std::vector<reco::TransientTrack> transtriplet;
-            transtriplet.push_back(reco::TransientTrack(tr1, bfield));
-            transtriplet.push_back(reco::TransientTrack(tr2, bfield));
-            transtriplet.push_back(reco::TransientTrack(tr3, bfield));
-            TransientVertex dsvtx = vtxFitter.vertex(transtriplet);
-            if(!dsvtx.isValid()) continue;
-            if(dsvtx.normalisedChiSquared()>5.) continue;
-            if(dsvtx.normalisedChiSquared()<0.) continue;
-
-            // set properties of the Ds candidate
-            HToDsMeson_mass.push_back( dsP4.M() );
-            HToDsMeson_pt.push_back( dsP4.pt() );
-            HToDsMeson_eta.push_back( dsP4.eta() );
-            HToDsMeson_phi.push_back( dsP4.phi() );
-            HToDsMeson_PhiMeson_mass.push_back( phiP4.M() );
-            HToDsMeson_PhiMeson_pt.push_back( phiP4.pt() );
-            HToDsMeson_PhiMeson_eta.push_back( phiP4.eta() );
-            HToDsMeson_PhiMeson_phi.push_back( phiP4.phi() );
-            HToDsMeson_PhiMeson_massDiff.push_back( dsP4.M() - phiP4.M() );
-            HToDsMeson_Pi_pt.push_back( piP4.pt() );
-            HToDsMeson_Pi_eta.push_back( piP4.eta() );
-            HToDsMeson_Pi_phi.push_back( piP4.phi() );
-            HToDsMeson_Pi_charge.push_back( tr3.charge() );
-            HToDsMeson_KPlus_pt.push_back( KPlusP4.pt() );
-            HToDsMeson_KPlus_eta.push_back( KPlusP4.eta() );
-            HToDsMeson_KPlus_phi.push_back( KPlusP4.phi() );
-            HToDsMeson_KPlus_charge.push_back( postrack.charge() );
-            HToDsMeson_KMinus_pt.push_back( KMinusP4.pt() );
-            HToDsMeson_KMinus_eta.push_back( KMinusP4.eta() );
-            HToDsMeson_KMinus_phi.push_back( KMinusP4.phi() );
-            HToDsMeson_KMinus_charge.push_back( negtrack.charge() );
-            HToDsMeson_tr1tr2_deltaR.push_back( reco::deltaR(tr1, tr2) );
-            HToDsMeson_tr3phi_deltaR.push_back( reco::deltaR(tr3, phiP4) );
-            HToDsMeson_phivtx_normchi2.push_back( phivtx.normalisedChiSquared() );
-            HToDsMeson_dsvtx_normchi2.push_back( dsvtx.normalisedChiSquared() );
-            HToDsMeson_tr1tr2_sepx.push_back( twotracksepx );
-            HToDsMeson_tr1tr2_sepy.push_back( twotracksepy );
-            HToDsMeson_tr1tr2_sepz.push_back( twotracksepz );
-            HToDsMeson_tr3phi_sepx.push_back( trackvtxsepx );
-            HToDsMeson_tr3phi_sepy.push_back( trackvtxsepy );
-            HToDsMeson_tr3phi_sepz.push_back( trackvtxsepz );
-
-            // check if this candidate can be matched to gen-level
-            bool hasFastGenMatch = false;
-            bool hasFastPartialGenMatch = false;
-            if( doMatching ){
-                for( const auto& pmap : HToDsGenParticles){
-                    double dRThreshold = 0.05;
-                    if( GenTools::isGeometricTrackMatch( tr3, *pmap.at("Pi"), dRThreshold )
-                        && GenTools::isGeometricTrackMatch( postrack, *pmap.at("KPlus"), dRThreshold )
-                        && GenTools::isGeometricTrackMatch( negtrack, *pmap.at("KMinus"), dRThreshold ) ){
-                        hasFastGenMatch = true;
-                    }
-                    if( GenTools::isGeometricTrackMatch( tr3, *pmap.at("Pi"), dRThreshold )
-                        || GenTools::isGeometricTrackMatch( postrack, *pmap.at("KPlus"), dRThreshold )
-                        || GenTools::isGeometricTrackMatch( negtrack, *pmap.at("KMinus"), dRThreshold ) ){
-                        hasFastPartialGenMatch = true;
-                    }
-                }
-            }
-            HToDsMeson_hasFastGenMatch.push_back( hasFastGenMatch );
-            HToDsMeson_hasFastPartialGenMatch.push_back( hasFastPartialGenMatch );
-
-            // break loop over third track in case maximum number was reached
-            if( HToDsMeson_mass.size() == nHToDsMeson_max ) break;
-
-        } // end loop over third track
-        if( HToDsMeson_mass.size() == nHToDsMeson_max ) break;
-      }
-      if( HToDsMeson_mass.size() == nHToDsMeson_max) break;
-    } // end loop over first and second track
-    delete bfield;
+        HToDsMeson_hasFastGenMatch.push_back( hasFastGenMatch );
+        HToDsMeson_hasFastPartialGenMatch.push_back( hasFastPartialGenMatch );
+    } // end loop over candidates
 
     // make the table
     auto table = std::make_unique<nanoaod::FlatTable>(HToDsMeson_mass.size(), name, false);
@@ -318,8 +301,7 @@ void HToDsMesonProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSet
     table->addColumn<bool>("hasFastGenmatch", HToDsMeson_hasFastGenMatch, "");
     table->addColumn<bool>("hasFastPartialGenmatch", HToDsMeson_hasFastPartialGenMatch, "");
 
-    // add the table to the output
-    iEvent.put(std::move(table), name);
+    return table;
 }
 
 // define this as a plug-in
@@ -0,0 +1,17 @@
+/*
+Incremental vertex fit for adding one track to an already fitted vertex.
+*/
+
+// local include files
+#include "PhysicsTools/HcNano/interface/IncrementalVertexFitter.h"
+
+// incremental vertex fitter //
+CachingVertex<5> IncrementalVertexFitter::addTrack(
+        const CachingVertex<5>& vertex,
+        const reco::TransientTrack& track) const {
+    // linearize the new track around the current vertex position
+    auto linearizedTrack = theLinearizer.linearizedTrackState(vertex.position(), track);
+    auto vertexTrack = theVertexTrackFactory.vertexTrack(linearizedTrack, vertex.vertexState());
+    // single Kalman update with the new track
+    return theUpdator.add(vertex, vertexTrack);
+}
@@ -0,0 +1,110 @@
+/*
+Lightweight vertex fitter for a fixed, small number of tracks (two or three).
+*/
+
+// system include files
+#include <cmath>
+#include <vector>
+
+// local include files
+#include "PhysicsTools/HcNano/interface/LightVertexFitter.h"
+
+// algebra and trajectory state include files
+#include "DataFormats/CLHEP/interface/AlgebraicObjects.h"
+#include "DataFormats/GeometryCommonDetAlgo/interface/GlobalError.h"
+#include "TrackingTools/TrajectoryState/interface/TrajectoryStateClosestToPoint.h"
+
+// constructor //
+LightVertexFitter::LightVertexFitter(unsigned maxIterations, double maxShift)
+  : theMaxIterations(maxIterations),
+    theMaxShift(maxShift){}
+
+// fit //
+template<unsigned N> TransientVertex LightVertexFitter::vertex(
+        const std::array<const reco::TransientTrack*, N>& tracks) const {
+
+    // initial vertex estimate: average of the track reference points
+    AlgebraicVector3 position;
+    for(unsigned n=0; n<N; n++){
+        GlobalPoint refPoint = tracks[n]->initialFreeState().position();
+        position += AlgebraicVector3(refPoint.x(), refPoint.y(), refPoint.z());
+    }
+    position /= N;
+
+    // iterate
+    std::array<AlgebraicVector3, N> points;
+    std::array<AlgebraicSymMatrix33, N> weights;
+    AlgebraicSymMatrix33 covariance;
+    for(unsigned iteration=0; iteration<theMaxIterations; iteration++){
+
+        // approximate each track as a straight line
+        // through its point of closest approach to the current vertex estimate
+        AlgebraicSymMatrix33 weightSum;
+        AlgebraicVector3 weightedPointSum;
+        GlobalPoint estimate(position[0], position[1], position[2]);
+        for(unsigned n=0; n<N; n++){
+            TrajectoryStateClosestToPoint tscp = tracks[n]->trajectoryStateClosestToPoint(estimate);
+            if( !tscp.isValid() || !tscp.hasError() ) return TransientVertex();
+            GlobalPoint point = tscp.position();
+            GlobalVector momentum = tscp.momentum();
+            const AlgebraicSymMatrix55& perigeeCov = tscp.perigeeError().covarianceMatrix();
+
+            // transverse and longitudinal uncertainty
+            // (note: the longitudinal impact parameter is measured along z,
+            //  its projection on the plane perpendicular to the track scales with sin(theta))
+            double sinTheta = momentum.perp()/momentum.mag();
+            double sigmaT2 = perigeeCov(3,3);
+            double sigmaL2 = perigeeCov(4,4)*sinTheta*sinTheta;
+            if( sigmaT2 <= 0 || sigmaL2 <= 0 ) return TransientVertex();
+
+            // orthonormal basis perpendicular to the track direction
+            // (note: e1 is transverse to the beam, e2 completes the basis)
+            AlgebraicVector3 u(momentum.x(), momentum.y(), momentum.z());
+            u /= momentum.mag();
+            AlgebraicVector3 e1(-u[1], u[0], 0.);
+            e1 /= ROOT::Math::Mag(e1);
+            AlgebraicVector3 e2 = ROOT::Math::Cross(u, e1);
+
+            // weight matrix of the distance to the line
+            AlgebraicSymMatrix33 weight;
+            for(unsigned a=0; a<3; a++){
+                for(unsigned b=a; b<3; b++){
+                    weight(a,b) = e1[a]*e1[b]/sigmaT2 + e2[a]*e2[b]/sigmaL2;
+                }
+            }
+            points[n] = AlgebraicVector3(point.x(), point.y(), point.z());
+            weights[n] = weight;
+            weightSum += weight;
+            weightedPointSum += weight*points[n];
+        }
+
+        // solve for the new vertex position
+        covariance = weightSum;
+        if( !covariance.Invert() ) return TransientVertex();
+        AlgebraicVector3 newPosition = covariance*weightedPointSum;
+        double shift = ROOT::Math::Mag(newPosition - position);
+        position = newPosition;
+        if( shift < theMaxShift ) break;
+    }
+
+    // calculate chi2
+    // (note: with respect to the track lines of the last iteration)
+    double chi2 = 0;
+    for(unsigned n=0; n<N; n++){
+        chi2 += ROOT::Math::Similarity(position - points[n], weights[n]);
+    }
+    float ndf = 2.*N - 3.;
+
+    // make the vertex
+    // (note: no refitted tracks are attached to the vertex)
+    return TransientVertex(GlobalPoint(position[0], position[1], position[2]),
+                           GlobalError(covariance),
+                           std::vector<reco::TransientTrack>(),
+                           chi2, ndf);
+}
+
+// explicit instantiations //
+template TransientVertex LightVertexFitter::vertex<2>(
+    const std::array<const reco::TransientTrack*, 2>&) const;
+template TransientVertex LightVertexFitter::vertex<3>(
+    const std::array<const reco::TransientTrack*, 3>&) const;
@@ -0,0 +1,173 @@
+/*
+Custom analyzer class for finding charmed mesons in several decay channels at once.
+*/
+
+// general include files
+#include "FWCore/Utilities/interface/Exception.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/MultiChannelMesonProducer.h"
+#include "PhysicsTools/HcNano/interface/DStarMesonProducer.h"
+#include "PhysicsTools/HcNano/interface/HToDStarMesonProducer.h"
+#include "PhysicsTools/HcNano/interface/DsMesonProducer.h"
+#include "PhysicsTools/HcNano/interface/HToDsMesonProducer.h"
+
+// constructor //
+template<class... Producers>
+MultiChannelMesonProducer<Producers...>::MultiChannelMesonProducer(const edm::ParameterSet& iConfig)
+  : names(iConfig.getParameter<std::vector<std::string>>("names")),
+    dtype(iConfig.getParameter<std::string>("dtype")),
+    finderConfig(iConfig),
+    cutFlow(iConfig.getParameter<bool>("cutFlow")),
+    selectedTracksToken(this->template consumes<SelectedTracks>(
+        iConfig.getParameter<edm::InputTag>("selectedTracksToken"))),
+    genEventIndexToken(this->template consumes<GenEventIndex>(
+        iConfig.getParameter<edm::InputTag>("genEventIndexToken"))){
+    // check the number of output table names
+    if( names.size()!=nChannels ){
+        throw cms::Exception("MultiChannelMesonProducer")
+            << "expected " << nChannels << " output table names, found " << names.size();
+    }
+    // declare tables to be produced
+    // (note: the budget is shared between the channels,
+    //  but its table is written for each channel, as in the single-channel producers)
+    for( const std::string& name : names ){
+        this->template produces<nanoaod::FlatTable>(name);
+        this->template produces<nanoaod::FlatTable>(name+"Budget");
+        if( cutFlow ){
+            this->template produces<nanoaod::MergeableCounterTable, edm::Transition::EndLuminosityBlock>(
+                name+"CutFlow");
+        }
+    }
+}
+
+// destructor //
+template<class... Producers>
+MultiChannelMesonProducer<Producers...>::~MultiChannelMesonProducer(){}
+
+// beginning of stream //
+template<class... Producers>
+std::unique_ptr<ThreeProngCandidateFinder<typename Producers::Decay...>>
+MultiChannelMesonProducer<Producers...>::beginStream(edm::StreamID) const {
+    return std::make_unique<ThreeProngCandidateFinder<typename Producers::Decay...>>(finderConfig);
+}
+
+// end of stream //
+template<class... Producers>
+void MultiChannelMesonProducer<Producers...>::endStream(edm::StreamID id) const {
+    std::string name = names[0];
+    for(size_t k=1; k<nChannels; k++) name += "+" + names[k];
+    this->streamCache(id)->print(name);
+    std::lock_guard<std::mutex> lock(jobTimersMutex);
+    jobTimers.merge(this->streamCache(id)->timers());
+}
+
+// end of job //
+template<class... Producers>
+void MultiChannelMesonProducer<Producers...>::endJob(){
+    std::string name = names[0];
+    for(size_t k=1; k<nChannels; k++) name += "+" + names[k];
+    jobTimers.print(name);
+}
+
+// luminosity blocks //
+// (note: see the single-channel producers, with one set of counters per channel)
+template<class... Producers>
+std::shared_ptr<typename MultiChannelMesonProducer<Producers...>::CutFlows>
+MultiChannelMesonProducer<Producers...>::globalBeginLuminosityBlockSummary(
+        const edm::LuminosityBlock&, const edm::EventSetup&) const {
+    return std::make_shared<CutFlows>();
+}
+
+template<class... Producers>
+void MultiChannelMesonProducer<Producers...>::streamEndLuminosityBlockSummary(edm::StreamID id,
+        const edm::LuminosityBlock&, const edm::EventSetup&, CutFlows* lumiCutFlows) const {
+    for(size_t k=0; k<nChannels; k++){
+        CutFlow& streamCutFlow = this->streamCache(id)->cutFlow(k);
+        (*lumiCutFlows)[k].add(streamCutFlow);
+        streamCutFlow.reset();
+    }
+}
+
+template<class... Producers>
+void MultiChannelMesonProducer<Producers...>::globalEndLuminosityBlockSummary(
+        const edm::LuminosityBlock&, const edm::EventSetup&, CutFlows*) const {}
+
+template<class... Producers>
+void MultiChannelMesonProducer<Producers...>::globalEndLuminosityBlockProduce(edm::LuminosityBlock& iLumi,
+        const edm::EventSetup&, const CutFlows* lumiCutFlows) const {
+    if( !cutFlow ) return;
+    for(size_t k=0; k<nChannels; k++){
+        iLumi.put((*lumiCutFlows)[k].makeTable(names[k]+"CutFlow"), names[k]+"CutFlow");
+    }
+}
+
+// descriptions //
+template<class... Producers>
+void MultiChannelMesonProducer<Producers...>::fillDescriptions(edm::ConfigurationDescriptions &descriptions){
+    edm::ParameterSetDescription desc;
+    desc.add<std::vector<std::string>>("names");
+    desc.add<std::string>("dtype", "Data type (mc or data)");
+    ThreeProngCandidateFinder<typename Producers::Decay...>::fillDescriptions(desc);
+    desc.add<edm::InputTag>("selectedTracksToken", edm::InputTag("selectedTracksToken"));
+    desc.add<edm::InputTag>("genEventIndexToken", edm::InputTag("genEventIndexToken"));
+    descriptions.addWithDefaultLabel(desc);
+}
+
+// produce (main method) //
+template<class... Producers>
+void MultiChannelMesonProducer<Producers...>::produce(edm::StreamID id,
+                                                      edm::Event& iEvent,
+                                                      const edm::EventSetup& iSetup) const {
+
+    // candidate finder of this stream
+    ThreeProngCandidateFinder<typename Producers::Decay...>& candidateFinder = *this->streamCache(id);
+
+    // get all required objects from tokens
+    edm::Handle<SelectedTracks> selectedTracksHandle;
+    iEvent.getByToken(selectedTracksToken, selectedTracksHandle);
+    edm::Handle<GenEventIndex> genEventIndexHandle;
+    iEvent.getByToken(genEventIndexToken, genEventIndexHandle);
+
+    // settings for gen-matching
+    const GenEventIndex* genEventIndex = nullptr;
+    if( dtype=="mc" && genEventIndexHandle.isValid() ) genEventIndex = genEventIndexHandle.product();
+
+    // find the candidates in all channels at once
+    std::array<std::vector<ThreeProngCandidate>, nChannels> candidates;
+    candidateFinder.find(*selectedTracksHandle, iEvent.id(), {Producers::maxCandidates...}, candidates);
+
+    // make the tables and add them to the output
+    // (note: if timing is enabled, the per-event cost is added to the budget tables)
+    StageTimers& timers = candidateFinder.timers();
+    {
+        StageTimers::Scope timer = timers.scope(StageTimers::Tables);
+        putTables(iEvent, candidates, *selectedTracksHandle, genEventIndex,
+                  std::index_sequence_for<Producers...>{});
+    }
+    const EventBudget& budget = candidateFinder.budget();
+    timers.finish(selectedTracksHandle->size(), budget.nPairs(), budget.nFits());
+    for( const std::string& name : names ){
+        std::unique_ptr<nanoaod::FlatTable> budgetTable = budget.makeTable(name+"Budget");
+        if( timers.enabled() ) timers.addColumns(*budgetTable);
+        iEvent.put(std::move(budgetTable), name+"Budget");
+    }
+}
+
+// make the output tables //
+template<class... Producers>
+template<size_t... K>
+void MultiChannelMesonProducer<Producers...>::putTables(
+        edm::Event& iEvent,
+        const std::array<std::vector<ThreeProngCandidate>, nChannels>& candidates,
+        const SelectedTracks& selectedTracks,
+        const GenEventIndex* genEventIndex,
+        std::index_sequence<K...>) const {
+    (iEvent.put(Producers::makeTable(names[K], candidates[K], selectedTracks, genEventIndex), names[K]), ...);
+}
+
+// define the plug-ins
+typedef MultiChannelMesonProducer<DStarMesonProducer, DsMesonProducer> DStarDsMesonProducer;
+typedef MultiChannelMesonProducer<HToDStarMesonProducer, HToDsMesonProducer> HToDStarDsMesonProducer;
+DEFINE_FWK_MODULE(DStarDsMesonProducer);
+DEFINE_FWK_MODULE(HToDStarDsMesonProducer);
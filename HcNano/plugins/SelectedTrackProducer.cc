@@ -0,0 +1,92 @@
+/*
+Custom producer class for preselecting tracks for charmed meson reconstruction.
+
+The packed PF candidates and lost tracks are merged,
+and the tracks passing the preselection are stored in a SelectedTracks product.
+This is done only once per event, and the product is shared by all charmed meson producers.
+*/
+
+// local include files
+#include "PhysicsTools/HcNano/interface/SelectedTrackProducer.h"
+
+// constructor //
+SelectedTrackProducer::SelectedTrackProducer(const edm::ParameterSet& iConfig)
+  : minPt(iConfig.getParameter<double>("minPt")),
+    quality(reco::TrackBase::qualityByName(iConfig.getParameter<std::string>("quality"))),
+    gridCellSize(iConfig.getParameter<double>("gridCellSize")),
+    gridEtaMax(iConfig.getParameter<double>("gridEtaMax")),
+    packedPFCandidatesToken(consumes<std::vector<pat::PackedCandidate>>(
+        iConfig.getParameter<edm::InputTag>("packedPFCandidatesToken"))),
+    lostTracksToken(consumes<std::vector<pat::PackedCandidate>>(
+        iConfig.getParameter<edm::InputTag>("lostTracksToken"))){
+    // declare products
+    produces<SelectedTracks>();
+}
+
+// destructor //
+SelectedTrackProducer::~SelectedTrackProducer(){}
+
+// descriptions //
+void SelectedTrackProducer::fillDescriptions(edm::ConfigurationDescriptions &descriptions){
+    edm::ParameterSetDescription desc;
+    desc.add<double>("minPt", 0.3);
+    desc.add<std::string>("quality", "highPurity");
+    desc.add<double>("gridCellSize", 0.4);
+    desc.add<double>("gridEtaMax", 3.0);
+    desc.add<edm::InputTag>("packedPFCandidatesToken", edm::InputTag("packedPFCandidatesToken"));
+    desc.add<edm::InputTag>("lostTracksToken", edm::InputTag("lostTracksToken"));
+    descriptions.addWithDefaultLabel(desc);
+}
+
+// produce (main method) //
+void SelectedTrackProducer::produce(edm::StreamID, edm::Event& iEvent, const edm::EventSetup& iSetup) const {
+
+    // get all required objects from tokens
+    edm::Handle<std::vector<pat::PackedCandidate>> packedPFCandidates;
+    iEvent.getByToken(packedPFCandidatesToken, packedPFCandidates);
+    edm::Handle<std::vector<pat::PackedCandidate>> lostTracks;
+    iEvent.getByToken(lostTracksToken, lostTracks);
+
+    // merge packed candidate tracks and lost tracks
+    // (note: the order is the same as before this was moved out of the meson producers,
+    //  i.e. first all packed candidates and then all lost tracks)
+    auto selectedTracks = std::make_unique<SelectedTracks>();
+    selectedTracks->reserve(packedPFCandidates->size() + lostTracks->size());
+    addTracks(packedPFCandidates, *selectedTracks);
+    addTracks(lostTracks, *selectedTracks);
+
+    // make an eta-phi grid of the selected tracks
+    // (note: the cell size should preferably be close to the largest deltaR
+    //  used in the downstream pairing, but smaller or larger cells give the same result)
+    std::vector<double> etas;
+    std::vector<double> phis;
+    etas.reserve(selectedTracks->size());
+    phis.reserve(selectedTracks->size());
+    for(const reco::Track* track: selectedTracks->tracks()){
+        etas.push_back(track->eta());
+        phis.push_back(track->phi());
+    }
+    selectedTracks->setGrid(EtaPhiGrid(etas, phis, gridCellSize, gridEtaMax));
+
+    // add the selected tracks to the event
+    iEvent.put(std::move(selectedTracks));
+}
+
+// helper functions //
+void SelectedTrackProducer::addTracks(
+        const edm::Handle<std::vector<pat::PackedCandidate>>& candidates,
+        SelectedTracks& selectedTracks) const {
+    // preselect tracks from a collection of packed candidates
+    for(size_t idx=0; idx < candidates->size(); idx++){
+        const pat::PackedCandidate& pc = (*candidates)[idx];
+        if(!pc.hasTrackDetails()) continue;
+        const reco::Track* track = pc.bestTrack();
+        if(!track->quality(quality)) continue;
+        if(track->pt() < minPt) continue;
+        // (note: the pseudo-track is owned by the packed candidate, only a pointer is kept)
+        selectedTracks.push_back(track, reco::CandidatePtr(candidates, idx));
+    }
+}
+
+// define this as a plug-in
+DEFINE_FWK_MODULE(SelectedTrackProducer);
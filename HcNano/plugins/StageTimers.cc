@@ -0,0 +1,101 @@
+/*
+Per-stage timers for the charmed meson producers.
+*/
+
+// system include files
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+// local include files
+#include "PhysicsTools/HcNano/interface/StageTimers.h"
+
+// stage names //
+const std::array<std::string, StageTimers::nStages> StageTimers::stageNames = {
+    "pairs",
+    "pairFits",
+    "triplets",
+    "tripletFits",
+    "candidates",
+    "tables"
+};
+
+// combine //
+void StageTimers::add(const StageTimers& other){
+    for(size_t s=0; s<nStages; s++) theEventTime[s] += other.theEventTime[s];
+}
+
+// end of event //
+void StageTimers::finish(unsigned long nTracks, unsigned long nPairs, unsigned long nFits){
+    if( !theEnabled ) return;
+    theEventTracks = nTracks;
+    theNEvents++;
+    theNTracks += nTracks;
+    theNPairs += nPairs;
+    theNFits += nFits;
+    for(size_t s=0; s<nStages; s++){
+        theTotalTime[s] += theEventTime[s];
+        unsigned bin = (theEventTime[s] < 1.) ? 0 : unsigned(std::log2(theEventTime[s])) + 1;
+        theHistograms[s][std::min(bin, nBins-1)]++;
+    }
+}
+
+void StageTimers::merge(const StageTimers& other){
+    theEnabled = theEnabled || other.theEnabled;
+    theNEvents += other.theNEvents;
+    theNTracks += other.theNTracks;
+    theNPairs += other.theNPairs;
+    theNFits += other.theNFits;
+    for(size_t s=0; s<nStages; s++){
+        theTotalTime[s] += other.theTotalTime[s];
+        for(unsigned b=0; b<nBins; b++) theHistograms[s][b] += other.theHistograms[s][b];
+    }
+}
+
+// output columns //
+void StageTimers::addColumns(nanoaod::FlatTable& table) const {
+    table.addColumnValue<int>("nSelectedTracks", theEventTracks, "number of selected tracks");
+    for(size_t s=0; s<nStages; s++){
+        table.addColumnValue<float>(stageNames[s] + "Time", theEventTime[s],
+            "time spent in stage " + stageNames[s] + " (in microseconds)");
+    }
+}
+
+// summary //
+void StageTimers::print(const std::string& name) const {
+    if( !theEnabled || theNEvents==0 ) return;
+    double totalTime = 0.;
+    for(size_t s=0; s<nStages; s++) totalTime += theTotalTime[s];
+    std::cout << "Stage timers for " << name << ":" << std::endl;
+    std::cout << "  events: " << theNEvents << std::endl;
+    std::cout << "  selected tracks per event: " << double(theNTracks)/theNEvents << std::endl;
+    std::cout << "  pairs tested per event: " << double(theNPairs)/theNEvents << std::endl;
+    std::cout << "  vertex fits per event: " << double(theNFits)/theNEvents << std::endl;
+    std::cout << "  " << std::left << std::setw(12) << "stage" << std::right;
+    std::cout << std::setw(14) << "total (s)" << std::setw(14) << "mean (us)";
+    std::cout << std::setw(14) << "median (us)" << std::setw(14) << "99% (us)";
+    std::cout << std::setw(10) << "fraction" << std::endl;
+    for(size_t s=0; s<nStages; s++){
+        // (note: the quantiles are the upper edges of the histogram bins they fall in)
+        std::array<double, 2> quantiles = {0.5, 0.99};
+        std::array<double, 2> edges = {0., 0.};
+        for(size_t q=0; q<quantiles.size(); q++){
+            unsigned long cumulative = 0;
+            for(unsigned b=0; b<nBins; b++){
+                cumulative += theHistograms[s][b];
+                if( cumulative >= quantiles[q]*theNEvents ){
+                    edges[q] = std::ldexp(1., b);
+                    break;
+                }
+            }
+        }
+        std::cout << "  " << std::left << std::setw(12) << stageNames[s] << std::right;
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << std::setw(14) << theTotalTime[s]*1e-6;
+        std::cout << std::setw(14) << theTotalTime[s]/theNEvents;
+        std::cout << std::setw(14) << edges[0] << std::setw(14) << edges[1];
+        std::cout << std::setw(10) << (totalTime>0 ? theTotalTime[s]/totalTime : 0.);
+        std::cout << std::defaultfloat << std::endl;
+    }
+}
@@ -0,0 +1,537 @@
+/*
+Reconstruction engine for three-prong charmed meson candidates.
+*/
+
+// system include files
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+// general include files
+#include "FWCore/ParameterSet/interface/allowedValues.h"
+
+// tbb include files
+#include "tbb/parallel_for.h"
+
+// local include files
+#include "PhysicsTools/HcNano/interface/ThreeProngCandidateFinder.h"
+
+// constructor //
+template<class... Decays>
+ThreeProngCandidateFinder<Decays...>::ThreeProngCandidateFinder(const edm::ParameterSet& iConfig)
+  : theConfig(iConfig),
+    thePairBatchSize(iConfig.getParameter<unsigned int>("pairBatchSize")),
+    theParallelTrackThreshold(iConfig.getParameter<unsigned int>("parallelTrackThreshold")),
+    theParallelChunks(iConfig.getParameter<unsigned int>("parallelChunks")),
+    theBField("3_8T"),
+    theVertexFitter(iConfig.getParameter<std::string>("vertexFitter"),
+                    iConfig.getParameter<bool>("incrementalTripletFit"),
+                    iConfig.getParameter<unsigned int>("incrementalFitValidationInterval"),
+                    iConfig.getParameter<unsigned int>("vertexFitterComparisonInterval"),
+                    std::max({Decays::maxThreeProngNormChi2...})),
+    theDCAFilter(iConfig.getParameter<double>("maxTwoTrackDCA")),
+    theRanking(iConfig.getParameter<std::string>("candidateRanking")),
+    theBudget(iConfig.getParameter<unsigned int>("maxPairsPerEvent"),
+              iConfig.getParameter<unsigned int>("maxVertexFitsPerEvent"),
+              iConfig.getParameter<double>("maxTimePerEvent")){
+    const bool cutFlow = iConfig.getParameter<bool>("cutFlow");
+    forEachChannel([&](auto& channel, size_t){ channel.cutFlow().enable(cutFlow); });
+    theTimers.enable(iConfig.getParameter<bool>("stageTimers"));
+}
+
+// descriptions //
+template<class... Decays>
+void ThreeProngCandidateFinder<Decays...>::fillDescriptions(edm::ParameterSetDescription& desc){
+    desc.add<unsigned int>("pairBatchSize", 32);
+    desc.add<double>("maxTwoTrackDCA", 0.);
+    desc.ifValue(edm::ParameterDescription<std::string>("vertexFitter", "kalman", true),
+                 edm::allowedValues<std::string>("kalman", "light"));
+    desc.add<unsigned int>("vertexFitterComparisonInterval", 0);
+    desc.add<bool>("incrementalTripletFit", false);
+    desc.add<unsigned int>("incrementalFitValidationInterval", 0);
+    desc.ifValue(edm::ParameterDescription<std::string>("candidateRanking", "first", true),
+                 edm::allowedValues<std::string>("first", "normChi2", "massDiff", "pt"));
+    desc.add<unsigned int>("parallelTrackThreshold", 0);
+    desc.add<unsigned int>("parallelChunks", 8);
+    desc.add<unsigned int>("maxPairsPerEvent", 0);
+    desc.add<unsigned int>("maxVertexFitsPerEvent", 0);
+    desc.add<double>("maxTimePerEvent", 0.);
+    desc.add<bool>("cutFlow", false);
+    desc.add<bool>("stageTimers", false);
+}
+
+// helper for looping over channels //
+template<class... Decays>
+template<class F>
+void ThreeProngCandidateFinder<Decays...>::forEachChannel(F&& f){
+    forEachChannel(std::forward<F>(f), std::index_sequence_for<Decays...>{});
+}
+
+template<class... Decays>
+template<class F, size_t... K>
+void ThreeProngCandidateFinder<Decays...>::forEachChannel(F&& f, std::index_sequence<K...>){
+    (f(std::get<K>(theChannels), K), ...);
+}
+
+template<class... Decays>
+template<class F>
+void ThreeProngCandidateFinder<Decays...>::forEachChannel(F&& f) const {
+    forEachChannel(std::forward<F>(f), std::index_sequence_for<Decays...>{});
+}
+
+template<class... Decays>
+template<class F, size_t... K>
+void ThreeProngCandidateFinder<Decays...>::forEachChannel(F&& f, std::index_sequence<K...>) const {
+    (f(std::get<K>(theChannels), K), ...);
+}
+
+// find (main method) //
+template<class... Decays>
+void ThreeProngCandidateFinder<Decays...>::find(
+        const SelectedTracks& tracks,
+        const edm::EventID& eventID,
+        const std::array<unsigned, nChannels>& maxCandidates,
+        std::array<std::vector<ThreeProngCandidate>, nChannels>& candidates){
+    const EventRandom random(eventID);
+    theBudget.start();
+    theTimers.start();
+    countPairs(tracks);
+
+    // split events with many tracks into chunks processed in parallel
+    // (note: a threshold of 0 disables the parallel processing)
+    if( theParallelTrackThreshold>0 && theParallelChunks>1
+        && tracks.size()>=theParallelTrackThreshold ){
+        findParallel(tracks, random, maxCandidates, candidates);
+    } else findRange(tracks, random, 0, tracks.size(), maxCandidates, candidates);
+    theBudget.finish();
+}
+
+// find in a range of first tracks //
+template<class... Decays>
+void ThreeProngCandidateFinder<Decays...>::findRange(
+        const SelectedTracks& tracks,
+        const EventRandom& random,
+        unsigned beginTrack,
+        unsigned endTrack,
+        const std::array<unsigned, nChannels>& maxCandidates,
+        std::array<std::vector<ThreeProngCandidate>, nChannels>& candidates){
+
+    // prepare the transient tracks for the vertex fits
+    // (note: they are built lazily and at most once per selected track,
+    //  the same object is reused in all pair and triplet fits the track takes part in)
+    theTransientTracks.reset(tracks.tracks(), &theBField);
+    resetRanking(maxCandidates, candidates);
+
+    unsigned firstTrack = beginTrack;
+    while( firstTrack<endTrack ){
+
+      // check which channels still need candidates
+      // (note: when ranking, all channels stay active until the end)
+      std::array<bool, nChannels> active;
+      bool anyActive = false;
+      for(size_t k=0; k<nChannels; k++){
+          active[k] = theRanking.enabled() || (candidates[k].size() < maxCandidates[k]);
+          anyActive = anyActive || active[k];
+      }
+      if( !anyActive ) break;
+
+      // stop if the time budget for this event is exceeded
+      if( !theBudget.checkTime() ) break;
+
+      // stage 1: collect a batch of track pairs passing the kinematic and mass cuts
+      {
+          StageTimers::Scope timer = theTimers.scope(StageTimers::Pairs);
+          collectPairs(tracks, random, active, firstTrack, endTrack);
+      }
+
+      // stage 2: fit the two-track vertices of the batch
+      // (note: the two-track vertex does not depend on the mass hypotheses,
+      //  so it is fitted only once per pair, even if the pair is used in several channels)
+      if( !theBudget.countFits(thePairTracks.size()) ) break;
+      {
+          StageTimers::Scope timer = theTimers.scope(StageTimers::PairFits);
+          theVertexFitter.fitPairs(thePairTracks, theTransientTracks, thePairVertices);
+      }
+
+      forEachChannel([&](auto& channel, size_t k){
+          channel.setPairVertices(thePairVertices);
+
+          // stage 3: collect the third track candidates for all pairs with a good vertex
+          {
+              StageTimers::Scope timer = theTimers.scope(StageTimers::Triplets);
+              channel.collectTriplets(tracks, theRanking);
+          }
+
+          // stage 4-5: fit the three-track vertices of the batch
+          // and make the output candidates for all triplets with a good vertex
+          fitCandidates(channel, tracks, maxCandidates[k], candidates[k]);
+      });
+      if( theBudget.truncated() ) break;
+    }
+    collectRankedCandidates(candidates);
+}
+
+// stages 4-5: triplet fits and candidates //
+template<class... Decays>
+template<class Channel>
+bool ThreeProngCandidateFinder<Decays...>::fitCandidates(
+        Channel& channel,
+        const SelectedTracks& tracks,
+        unsigned maxCandidates,
+        std::vector<ThreeProngCandidate>& candidates){
+    // with ranking, all triplets of the batch are candidates, so they are fitted in one go
+    if( theRanking.enabled() ){
+        if( !theBudget.countFits(channel.nTriplets()) ) return false;
+        {
+            StageTimers::Scope timer = theTimers.scope(StageTimers::TripletFits);
+            channel.fitTriplets(theVertexFitter, theTransientTracks);
+        }
+        StageTimers::Scope timer = theTimers.scope(StageTimers::Candidates);
+        channel.collectCandidates(tracks, theRanking, maxCandidates, candidates);
+        return true;
+    }
+    // without ranking, only the first candidates are kept,
+    // so stop fitting as soon as there are enough of them
+    for(unsigned t=0; t<channel.nTriplets() && candidates.size()<maxCandidates; t++){
+        if( !theBudget.countFits(1) ) return false;
+        {
+            StageTimers::Scope timer = theTimers.scope(StageTimers::TripletFits);
+            channel.fitTriplet(t, theVertexFitter, theTransientTracks);
+        }
+        StageTimers::Scope timer = theTimers.scope(StageTimers::Candidates);
+        channel.collectCandidate(tracks, theRanking, t, candidates);
+    }
+    return true;
+}
+
+// find in parallel //
+template<class... Decays>
+void ThreeProngCandidateFinder<Decays...>::findParallel(
+        const SelectedTracks& tracks,
+        const EventRandom& random,
+        const std::array<unsigned, nChannels>& maxCandidates,
+        std::array<std::vector<ThreeProngCandidate>, nChannels>& candidates){
+
+    // make the copies of the engine
+    while( theWorkers.size()<theParallelChunks ){
+        theWorkers.push_back(std::make_unique<ThreeProngCandidateFinder>(theConfig));
+    }
+
+    // split the first tracks into chunks with approximately the same number of pairs
+    // (note: the second track always has a higher index than the first one,
+    //  so the number of pairs per first track decreases linearly with its index;
+    //  the chunks only depend on the number of tracks, not on the number of threads)
+    const unsigned nTracks = tracks.size();
+    std::vector<unsigned> boundaries(theParallelChunks+1, nTracks);
+    for(unsigned c=0; c<theParallelChunks; c++){
+        double fraction = double(c)/theParallelChunks;
+        boundaries[c] = unsigned(nTracks*(1. - std::sqrt(1. - fraction)));
+    }
+
+    // find the candidates in each chunk
+    // (note: each chunk stops as soon as it has the maximum number of candidates,
+    //  this is enough since only the first ones are kept after merging)
+    std::vector<std::array<std::vector<ThreeProngCandidate>, nChannels>> chunkCandidates(theParallelChunks);
+    // (note: the pair and vertex fit budgets are shared equally between the chunks)
+    tbb::parallel_for(0u, theParallelChunks, [&](unsigned c){
+        theWorkers[c]->theBudget.start(theParallelChunks);
+        theWorkers[c]->theTimers.start();
+        theWorkers[c]->findRange(tracks, random, boundaries[c], boundaries[c+1],
+                                 maxCandidates, chunkCandidates[c]);
+    });
+    for(unsigned c=0; c<theParallelChunks; c++) theBudget.add(theWorkers[c]->theBudget);
+    for(unsigned c=0; c<theParallelChunks; c++) theTimers.add(theWorkers[c]->theTimers);
+    for(unsigned c=0; c<theParallelChunks; c++){
+        forEachChannel([&](auto& channel, size_t){
+            typedef std::decay_t<decltype(channel)> Channel;
+            CutFlow& chunkCutFlow = std::get<Channel>(theWorkers[c]->theChannels).cutFlow();
+            channel.cutFlow().add(chunkCutFlow);
+            chunkCutFlow.clear();
+        });
+    }
+
+    // merge the chunks in order
+    if( theRanking.enabled() ){
+        // (note: the best candidates of each chunk are merged into the ranked candidates,
+        //  with ties broken by the order of the chunks)
+        resetRanking(maxCandidates, candidates);
+        for(unsigned c=0; c<theParallelChunks; c++){
+            forEachChannel([&](auto& channel, size_t){
+                typedef std::decay_t<decltype(channel)> Channel;
+                channel.mergeRankedCandidates(std::get<Channel>(theWorkers[c]->theChannels));
+            });
+        }
+        collectRankedCandidates(candidates);
+        return;
+    }
+    for(size_t k=0; k<nChannels; k++){
+        for(unsigned c=0; c<theParallelChunks; c++){
+            for(const ThreeProngCandidate& candidate : chunkCandidates[c][k]){
+                if( candidates[k].size() >= maxCandidates[k] ) break;
+                candidates[k].push_back(candidate);
+            }
+        }
+    }
+}
+
+// find from two-prong candidates //
+template<class... Decays>
+void ThreeProngCandidateFinder<Decays...>::find(
+        const SelectedTracks& tracks,
+        const std::array<const std::vector<TwoProngCandidate>*, nChannels>& twoProngs,
+        const std::array<unsigned, nChannels>& maxCandidates,
+        std::array<std::vector<ThreeProngCandidate>, nChannels>& candidates){
+
+    // prepare the transient tracks for the vertex fits
+    theTransientTracks.reset(tracks.tracks(), &theBField);
+    resetRanking(maxCandidates, candidates);
+    theBudget.start();
+    theTimers.start();
+    countPairs(tracks);
+
+    const TrackKinematics& kinematics = tracks.kinematics();
+    forEachChannel([&](auto& channel, size_t k){
+        const std::vector<TwoProngCandidate>& channelTwoProngs = *twoProngs[k];
+        size_t next = 0;
+        while( next<channelTwoProngs.size()
+               && (theRanking.enabled() || candidates[k].size()<maxCandidates[k]) ){
+
+            // stop if the time budget for this event is exceeded
+            if( !theBudget.checkTime() ) break;
+
+            // stage 1-2: take a batch of two-prong candidates passing the cuts of this channel
+            // (note: the two-track vertices were already fitted by the producer of the candidates,
+            //  so the triplet fits are done from scratch, without the incremental update)
+            {
+                StageTimers::Scope timer = theTimers.scope(StageTimers::Pairs);
+                channel.clear();
+                for( ; next<channelTwoProngs.size() && channel.nPairs()<thePairBatchSize; next++){
+                    channel.addTwoProng(kinematics, channelTwoProngs[next]);
+                }
+            }
+
+            // stage 3-5: same as above
+            {
+                StageTimers::Scope timer = theTimers.scope(StageTimers::Triplets);
+                channel.collectTriplets(tracks, theRanking);
+            }
+            if( !fitCandidates(channel, tracks, maxCandidates[k], candidates[k]) ) break;
+        }
+    });
+    collectRankedCandidates(candidates);
+    theBudget.finish();
+}
+
+// ranking //
+template<class... Decays>
+void ThreeProngCandidateFinder<Decays...>::resetRanking(
+        const std::array<unsigned, nChannels>& maxCandidates,
+        const std::array<std::vector<ThreeProngCandidate>, nChannels>& candidates){
+    if( !theRanking.enabled() ) return;
+    // (note: the ranked candidates are appended to the output vectors,
+    //  so only the remaining space is used)
+    forEachChannel([&](auto& channel, size_t k){
+        unsigned nCandidates = candidates[k].size();
+        channel.resetRanking(nCandidates<maxCandidates[k] ? maxCandidates[k]-nCandidates : 0);
+    });
+}
+
+template<class... Decays>
+void ThreeProngCandidateFinder<Decays...>::collectRankedCandidates(
+        std::array<std::vector<ThreeProngCandidate>, nChannels>& candidates){
+    if( !theRanking.enabled() ) return;
+    forEachChannel([&](auto& channel, size_t k){ channel.collectRankedCandidates(candidates[k]); });
+}
+
+// find two-prong candidates //
+template<class... Decays>
+void ThreeProngCandidateFinder<Decays...>::findTwoProngs(
+        const SelectedTracks& tracks,
+        const edm::EventID& eventID,
+        std::array<std::vector<TwoProngCandidate>, nChannels>& twoProngs){
+
+    // prepare the transient tracks for the vertex fits
+    theTransientTracks.reset(tracks.tracks(), &theBField);
+    const EventRandom random(eventID);
+    theBudget.start();
+    theTimers.start();
+    countPairs(tracks);
+
+    std::array<bool, nChannels> active;
+    active.fill(true);
+    unsigned firstTrack = 0;
+    while( firstTrack<tracks.size() ){
+        // stop if the time budget for this event is exceeded
+        if( !theBudget.checkTime() ) break;
+
+        // stage 1: collect a batch of track pairs passing the kinematic and mass cuts
+        {
+            StageTimers::Scope timer = theTimers.scope(StageTimers::Pairs);
+            collectPairs(tracks, random, active, firstTrack, tracks.size());
+        }
+
+        // stage 2: fit the two-track vertices of the batch
+        if( !theBudget.countFits(thePairTracks.size()) ) break;
+        {
+            StageTimers::Scope timer = theTimers.scope(StageTimers::PairFits);
+            theVertexFitter.fitPairs(thePairTracks, theTransientTracks, thePairVertices);
+        }
+
+        // keep the pairs with a good vertex
+        forEachChannel([&](auto& channel, size_t k){
+            channel.setPairVertices(thePairVertices);
+            channel.collectTwoProngs(twoProngs[k]);
+        });
+    }
+    theBudget.finish();
+}
+
+// cut flow: all pairs //
+template<class... Decays>
+void ThreeProngCandidateFinder<Decays...>::countPairs(const SelectedTracks& tracks){
+    // (note: counted once per event in the main instance, not in the parallel chunks,
+    //  and independently of the eta-phi grid used to search for the second track)
+    forEachChannel([&](auto& channel, size_t){ channel.cutFlow().countPairs(tracks.kinematics()); });
+}
+
+// stage 1: pairs //
+template<class... Decays>
+void ThreeProngCandidateFinder<Decays...>::collectPairs(
+        const SelectedTracks& tracks,
+        const EventRandom& random,
+        const std::array<bool, nChannels>& active,
+        unsigned& firstTrack,
+        unsigned endTrack){
+    // (note: the second track is only searched for among the tracks
+    //  in the neighbouring cells of the eta-phi grid around the first track,
+    //  using the largest search cone of all channels)
+    constexpr double maxTwoTrackDeltaR = std::max({Decays::maxTwoTrackDeltaR...});
+    constexpr double minTrackPt = std::min({Decays::minTrackPt...});
+    const TrackKinematics& kinematics = tracks.kinematics();
+    const EtaPhiGrid& trackGrid = tracks.grid();
+    thePairTracks.clear();
+    forEachChannel([&](auto& channel, size_t){ channel.clear(); });
+    for( ; firstTrack<endTrack && thePairTracks.size()<thePairBatchSize; firstTrack++){
+        const unsigned i = firstTrack;
+        if constexpr (minTrackPt > 0.){
+            if( kinematics.pt(i) < minTrackPt ) continue;
+        }
+        trackGrid.neighbours(kinematics.eta(i), kinematics.phi(i),
+                             maxTwoTrackDeltaR, theSecondTrackCandidates, i+1);
+
+        // evaluate the cheap two-track quantities for all second track candidates at once
+        kinematics.deltaR2(kinematics.eta(i), kinematics.phi(i),
+                           theSecondTrackCandidates, theTwoTrackDeltaR2);
+        kinematics.separation(kinematics.vx(i), kinematics.vy(i), kinematics.vz(i),
+                              theSecondTrackCandidates, theTwoTrackSepX, theTwoTrackSepY, theTwoTrackSepZ);
+        forEachChannel([&](auto& channel, size_t k){
+            if( active[k] ) channel.evaluate(kinematics, i, theSecondTrackCandidates);
+        });
+
+        for(unsigned n=0; n<theSecondTrackCandidates.size(); n++){
+            const unsigned j = theSecondTrackCandidates[n];
+
+            // stop if the pair budget for this event is exceeded
+            // (note: the pairs collected so far are still processed)
+            if( !theBudget.countPair() ){
+                firstTrack = endTrack;
+                return;
+            }
+
+            // candidates must have opposite charge
+            // note: now disabled for study to check if candidates with same charge
+            //       can be used for background estimation.
+            //if(tr1.charge() * tr2.charge() > 0) continue;
+
+            // cheap selection (direction, pt, reference points and mass) per channel
+            double twotracksepx = theTwoTrackSepX[n];
+            double twotracksepy = theTwoTrackSepY[n];
+            double twotracksepz = theTwoTrackSepZ[n];
+            std::array<bool, nChannels> selected;
+            bool anySelected = false;
+            forEachChannel([&](auto& channel, size_t k){
+                selected[k] = active[k] && channel.preselect(kinematics, n, i, j, theTwoTrackDeltaR2[n],
+                                                             twotracksepx, twotracksepy, twotracksepz);
+                anySelected = anySelected || selected[k];
+            });
+            if( !anySelected ) continue;
+
+            // find which track is positive and which is negative
+            unsigned posIndex;
+            unsigned negIndex;
+            if(kinematics.charge(i)>0. and kinematics.charge(j)<0){
+                posIndex = i;
+                negIndex = j;
+            } else if(kinematics.charge(i)<0. and kinematics.charge(j)>0){
+                posIndex = j;
+                negIndex = i;
+            } else {
+                // if both tracks have the same charge
+                // (e.g. in combinatorial background),
+                // assign them randomly.
+                // (note: the random number only depends on the event and the track pair,
+                //  so that the result is reproducible for any number of threads)
+                if( !random.flip(i, j) ){
+                    posIndex = i;
+                    negIndex = j;
+                } else {
+                    posIndex = j;
+                    negIndex = i;
+                }
+            }
+
+            // assign the tracks to the daughters and apply the mass selection per channel
+            const unsigned pair = thePairTracks.size();
+            anySelected = false;
+            forEachChannel([&](auto& channel, size_t k){
+                selected[k] = selected[k] && channel.select(tracks, pair, i, j, posIndex, negIndex,
+                                                            twotracksepx, twotracksepy, twotracksepz);
+                anySelected = anySelected || selected[k];
+            });
+            if( !anySelected ) continue;
+
+            // distance of closest approach between both tracks must be small
+            // (note: cheap analytic prefilter to avoid vertex fits for pairs that can not share a vertex)
+            if( !theDCAFilter.passes(theTransientTracks.get(i), theTransientTracks.get(j)) ) continue;
+
+            // add the pair to the batch
+            forEachChannel([&](auto& channel, size_t k){
+                if( !selected[k] ) return;
+                channel.cutFlow().count(CutFlow::TwoTrackDCA, kinematics, i, j);
+                channel.addPendingPair();
+            });
+            thePairTracks.push_back({i, j});
+        }
+    } // end loop over first and second track
+}
+
+// cut flow //
+template<class... Decays>
+CutFlow& ThreeProngCandidateFinder<Decays...>::cutFlow(size_t k){
+    CutFlow* result = nullptr;
+    forEachChannel([&](auto& channel, size_t l){ if( l==k ) result = &channel.cutFlow(); });
+    return *result;
+}
+
+// print //
+template<class... Decays>
+void ThreeProngCandidateFinder<Decays...>::print(const std::string& name) const {
+    theDCAFilter.print(name);
+    theVertexFitter.print(name);
+    theRanking.print(name);
+    theBudget.print(name);
+    forEachChannel([&](const auto& channel, size_t k){
+        channel.cutFlow().print(nChannels>1 ? name + " (channel " + std::to_string(k) + ")" : name);
+    });
+    for(unsigned c=0; c<theWorkers.size(); c++){
+        theWorkers[c]->print(name + " (parallel chunk " + std::to_string(c) + ")");
+    }
+}
+
+// explicit instantiations for the supported decay channels and combinations
+template class ThreeProngCandidateFinder<DStarDecay>;
+template class ThreeProngCandidateFinder<HToDStarDecay>;
+template class ThreeProngCandidateFinder<DsDecay>;
+template class ThreeProngCandidateFinder<HToDsDecay>;
+template class ThreeProngCandidateFinder<DStarDecay, DsDecay>;
+template class ThreeProngCandidateFinder<HToDStarDecay, HToDsDecay>;
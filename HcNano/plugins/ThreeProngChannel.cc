@@ -0,0 +1,413 @@
+/*
+Per-channel part of the three-prong candidate finder.
+*/
+
+// system include files
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// local include files
+#include "PhysicsTools/HcNano/interface/ThreeProngChannel.h"
+
+// clear //
+template<class Decay>
+void ThreeProngChannel<Decay>::clear(){
+    thePairs.clear();
+    theTriplets.clear();
+    theTripletTracks.clear();
+}
+
+// two-track quantities //
+template<class Decay>
+void ThreeProngChannel<Decay>::evaluate(const TrackKinematics& kinematics,
+                                        unsigned i,
+                                        const std::vector<unsigned>& secondTrackCandidates){
+    // (note: for daughters with different mass hypotheses,
+    //  the invariant mass is evaluated for both mass assignments)
+    kinematics.mass2(kinematics.energy(i, Decay::daughter1),
+                     kinematics.px(i), kinematics.py(i), kinematics.pz(i),
+                     Decay::daughter2, secondTrackCandidates, theTwoTrackMass2);
+    if constexpr (Decay::daughter1!=Decay::daughter2){
+        kinematics.mass2(kinematics.energy(i, Decay::daughter2),
+                         kinematics.px(i), kinematics.py(i), kinematics.pz(i),
+                         Decay::daughter1, secondTrackCandidates, theTwoTrackMass2Swapped);
+    }
+}
+
+// pair preselection //
+template<class Decay>
+bool ThreeProngChannel<Decay>::preselect(const TrackKinematics& kinematics,
+                                         unsigned n, unsigned i, unsigned j,
+                                         double deltaR2, double sepx, double sepy, double sepz){
+    // candidates must point approximately in the same direction
+    if( deltaR2 > Decay::maxTwoTrackDeltaR*Decay::maxTwoTrackDeltaR ) return false;
+    theCutFlow.count(CutFlow::TwoTrackDeltaR, kinematics, i, j);
+
+    // candidates must have pT greater than certain value
+    if constexpr (Decay::minTrackPt > 0.){
+        if( kinematics.pt(i) < Decay::minTrackPt || kinematics.pt(j) < Decay::minTrackPt ) return false;
+    }
+    theCutFlow.count(CutFlow::TrackPt, kinematics, i, j);
+
+    // reference points of both tracks must be close together
+    if( sepx>Decay::maxTwoTrackSepXY || sepy>Decay::maxTwoTrackSepXY || sepz>Decay::maxTwoTrackSepZ ) return false;
+    theCutFlow.count(CutFlow::TwoTrackSep, kinematics, i, j);
+
+    // invariant mass must be close to the two-prong mass for at least one mass assignment
+    // (note: this is only a fast prefilter based on the track kinematics cache,
+    //  the exact selection of the mass assignment is done in select)
+    bool passMass = std::abs(std::sqrt(std::max(theTwoTrackMass2[n], 0.))
+                             - Decay::twoProngMass) <= Decay::twoProngMassWindow;
+    if constexpr (Decay::daughter1!=Decay::daughter2){
+        passMass = passMass || std::abs(std::sqrt(std::max(theTwoTrackMass2Swapped[n], 0.))
+                                        - Decay::twoProngMass) <= Decay::twoProngMassWindow;
+    }
+    return passMass;
+}
+
+// pair selection //
+template<class Decay>
+bool ThreeProngChannel<Decay>::select(const SelectedTracks& tracks,
+                                      unsigned pair, unsigned i, unsigned j,
+                                      unsigned posIndex, unsigned negIndex,
+                                      double sepx, double sepy, double sepz){
+    constexpr double daughter1Mass = (Decay::daughter1==TrackKinematics::Pion) ?
+                                     TrackKinematics::pimass : TrackKinematics::kmass;
+    constexpr double daughter2Mass = (Decay::daughter2==TrackKinematics::Pion) ?
+                                     TrackKinematics::pimass : TrackKinematics::kmass;
+    const reco::Track& postrack = tracks.track(posIndex);
+    const reco::Track& negtrack = tracks.track(negIndex);
+
+    // make four-vectors and assign the tracks to the daughters
+    ROOT::Math::PtEtaPhiMVector daughter1P4;
+    ROOT::Math::PtEtaPhiMVector daughter2P4;
+    unsigned daughter1Index;
+    unsigned daughter2Index;
+    if constexpr (Decay::daughter1==Decay::daughter2){
+        // daughter1 is the positive and daughter2 the negative track
+        daughter1P4 = ROOT::Math::PtEtaPhiMVector(postrack.pt(), postrack.eta(), postrack.phi(), daughter1Mass);
+        daughter2P4 = ROOT::Math::PtEtaPhiMVector(negtrack.pt(), negtrack.eta(), negtrack.phi(), daughter2Mass);
+        daughter1Index = posIndex;
+        daughter2Index = negIndex;
+    } else {
+        // (note: although e.g. the D0 meson decays preferentially to K- pi+ rather than K+ pi-,
+        //  still both possibilities must be considered since the original particle could
+        //  be an anti-D0, which decays preferentially to K+ pi-)
+        ROOT::Math::PtEtaPhiMVector d1NegP4(negtrack.pt(), negtrack.eta(), negtrack.phi(), daughter1Mass);
+        ROOT::Math::PtEtaPhiMVector d2PosP4(postrack.pt(), postrack.eta(), postrack.phi(), daughter2Mass);
+        ROOT::Math::PtEtaPhiMVector d1PosP4(postrack.pt(), postrack.eta(), postrack.phi(), daughter1Mass);
+        ROOT::Math::PtEtaPhiMVector d2NegP4(negtrack.pt(), negtrack.eta(), negtrack.phi(), daughter2Mass);
+        double diff = std::abs((d1NegP4 + d2PosP4).M() - Decay::twoProngMass);
+        double diffSwapped = std::abs((d1PosP4 + d2NegP4).M() - Decay::twoProngMass);
+
+        // invariant mass must be close to resonance mass
+        if( diff < Decay::twoProngMassWindow && diff < diffSwapped ){
+            daughter1P4 = d1NegP4;
+            daughter2P4 = d2PosP4;
+            daughter1Index = negIndex;
+            daughter2Index = posIndex;
+        } else if( diffSwapped < Decay::twoProngMassWindow && diffSwapped < diff ){
+            daughter1P4 = d1PosP4;
+            daughter2P4 = d2NegP4;
+            daughter1Index = posIndex;
+            daughter2Index = negIndex;
+        } else return false;
+    }
+
+    // daughter1 must have a given minimum pt
+    if constexpr (Decay::minDaughter1Pt > 0.){
+        if( daughter1P4.pt() < Decay::minDaughter1Pt ) return false;
+    }
+
+    theCutFlow.count(CutFlow::TwoProngMass, tracks.kinematics(), i, j);
+    thePendingPair = {pair, i, j, posIndex, negIndex, daughter1Index, daughter2Index,
+                      daughter1P4, daughter2P4, daughter1P4 + daughter2P4,
+                      sepx, sepy, sepz, false, 0., 0., 0., 0.};
+    return true;
+}
+
+// pair vertices //
+template<class Decay>
+void ThreeProngChannel<Decay>::setPairVertices(const std::vector<TransientVertex>& pairVertices){
+    for(PairCandidate& pair : thePairs){
+        const TransientVertex& pairvtx = pairVertices[pair.pair];
+        pair.validVertex = pairvtx.isValid();
+        if( !pair.validVertex ) continue;
+        pair.vx = pairvtx.position().x();
+        pair.vy = pairvtx.position().y();
+        pair.vz = pairvtx.position().z();
+        pair.normChi2 = pairvtx.normalisedChiSquared();
+    }
+}
+
+// two-track candidates from the event //
+template<class Decay>
+bool ThreeProngChannel<Decay>::addTwoProng(const TrackKinematics& kinematics,
+                                           const TwoProngCandidate& twoProng){
+    const unsigned i = twoProng.track1;
+    const unsigned j = twoProng.track2;
+    // (note: the pairs passing the next stages are the two-prong candidates read from the event,
+    //  so the counts depend on the cuts of the producer of the candidates)
+
+    // candidates must point approximately in the same direction
+    double deta = kinematics.eta(i) - kinematics.eta(j);
+    double dphi = std::abs(kinematics.phi(i) - kinematics.phi(j));
+    if( dphi > M_PI ) dphi = 2*M_PI - dphi;
+    if( deta*deta + dphi*dphi > Decay::maxTwoTrackDeltaR*Decay::maxTwoTrackDeltaR ) return false;
+    theCutFlow.count(CutFlow::TwoTrackDeltaR, kinematics, i, j);
+
+    // candidates must have pT greater than certain value
+    if constexpr (Decay::minTrackPt > 0.){
+        if( kinematics.pt(i) < Decay::minTrackPt || kinematics.pt(j) < Decay::minTrackPt ) return false;
+    }
+    theCutFlow.count(CutFlow::TrackPt, kinematics, i, j);
+
+    // reference points of both tracks must be close together
+    if( twoProng.sepx>Decay::maxTwoTrackSepXY
+        || twoProng.sepy>Decay::maxTwoTrackSepXY
+        || twoProng.sepz>Decay::maxTwoTrackSepZ ) return false;
+    theCutFlow.count(CutFlow::TwoTrackSep, kinematics, i, j);
+
+    // invariant mass must be close to resonance mass
+    // (note: the mass assignment was already chosen by the producer of the candidates)
+    if( std::abs(twoProng.p4.M() - Decay::twoProngMass) > Decay::twoProngMassWindow ) return false;
+
+    // daughter1 must have a given minimum pt
+    if constexpr (Decay::minDaughter1Pt > 0.){
+        if( twoProng.daughter1P4.pt() < Decay::minDaughter1Pt ) return false;
+    }
+    theCutFlow.count(CutFlow::TwoProngMass, kinematics, i, j);
+    // (note: the distance of closest approach was already checked by the producer of the candidates)
+    theCutFlow.count(CutFlow::TwoTrackDCA, kinematics, i, j);
+
+    thePairs.push_back({CandidateVertexFitter::noPair, i, j,
+                        twoProng.posTrack, twoProng.negTrack,
+                        twoProng.daughter1Track, twoProng.daughter2Track,
+                        twoProng.daughter1P4, twoProng.daughter2P4, twoProng.p4,
+                        twoProng.sepx, twoProng.sepy, twoProng.sepz,
+                        true, twoProng.vx, twoProng.vy, twoProng.vz, twoProng.normChi2});
+    return true;
+}
+
+// two-track candidates for the event //
+template<class Decay>
+void ThreeProngChannel<Decay>::collectTwoProngs(std::vector<TwoProngCandidate>& twoProngs) const {
+    for(const PairCandidate& pair : thePairs){
+        // vertex must be valid and chi squared of fit must be small
+        if(!pair.validVertex) continue;
+        if(pair.normChi2>Decay::maxTwoProngNormChi2) continue;
+        if(pair.normChi2<0.) continue;
+
+        TwoProngCandidate twoProng;
+        twoProng.track1 = pair.track1;
+        twoProng.track2 = pair.track2;
+        twoProng.posTrack = pair.posTrack;
+        twoProng.negTrack = pair.negTrack;
+        twoProng.daughter1Track = pair.daughter1Track;
+        twoProng.daughter2Track = pair.daughter2Track;
+        twoProng.daughter1P4 = pair.daughter1P4;
+        twoProng.daughter2P4 = pair.daughter2P4;
+        twoProng.p4 = pair.twoProngP4;
+        twoProng.sepx = pair.sepx;
+        twoProng.sepy = pair.sepy;
+        twoProng.sepz = pair.sepz;
+        twoProng.vx = pair.vx;
+        twoProng.vy = pair.vy;
+        twoProng.vz = pair.vz;
+        twoProng.normChi2 = pair.normChi2;
+        twoProngs.push_back(twoProng);
+    }
+}
+
+// triplets //
+template<class Decay>
+void ThreeProngChannel<Decay>::collectTriplets(const SelectedTracks& tracks,
+                                               CandidateRanking& ranking){
+    constexpr double maxThirdTrackDeltaR2 = Decay::maxThirdTrackDeltaR*Decay::maxThirdTrackDeltaR;
+    const TrackKinematics& kinematics = tracks.kinematics();
+    const EtaPhiGrid& trackGrid = tracks.grid();
+    for(unsigned p=0; p<thePairs.size(); p++){
+        const PairCandidate& pair = thePairs[p];
+        const unsigned i = pair.track1;
+        const unsigned j = pair.track2;
+        const ROOT::Math::PtEtaPhiMVector& twoProngP4 = pair.twoProngP4;
+
+        // vertex must be valid
+        if(!pair.validVertex) continue;
+        // chi squared of fit must be small
+        if(pair.normChi2>Decay::maxTwoProngNormChi2) continue;
+        if(pair.normChi2<0.) continue;
+        theCutFlow.count(CutFlow::TwoProngFit, kinematics, i, j);
+
+        // skip pairs that can not beat the kept candidates
+        if( ranking.enabled() && theRankedCandidates.rejects(pairScoreBound(ranking, pair)) ){
+            ranking.countPrunedPair();
+            continue;
+        }
+
+        // loop over third track
+        // (note: only the tracks in the neighbouring cells of the eta-phi grid
+        //  around the direction of the two-track system are considered)
+        trackGrid.neighbours(twoProngP4.eta(), twoProngP4.phi(),
+                             Decay::maxThirdTrackDeltaR, theThirdTrackCandidates);
+
+        // evaluate the cheap third-track quantities for all third track candidates at once
+        kinematics.deltaR2(twoProngP4.eta(), twoProngP4.phi(), theThirdTrackCandidates, theThirdTrackDeltaR2);
+        kinematics.separation(pair.vx, pair.vy, pair.vz,
+                              theThirdTrackCandidates, theThirdTrackSepX, theThirdTrackSepY, theThirdTrackSepZ);
+        kinematics.mass2(twoProngP4.E(), twoProngP4.Px(), twoProngP4.Py(), twoProngP4.Pz(),
+                         Decay::thirdTrack, theThirdTrackCandidates, theThreeTrackMass2);
+
+        for(unsigned m=0; m<theThirdTrackCandidates.size(); m++){
+            const unsigned k = theThirdTrackCandidates[m];
+            if(k==i or k==j) continue;
+
+            // candidates must point approximately in the same direction
+            if( theThirdTrackDeltaR2[m] > maxThirdTrackDeltaR2 ) continue;
+            theCutFlow.count(CutFlow::ThirdTrackDeltaR, kinematics, i, j);
+
+            // candidates must have pT greater certain value
+            if constexpr (Decay::minThirdTrackPt > 0.){
+                if( kinematics.pt(k) < Decay::minThirdTrackPt ) continue;
+            }
+            theCutFlow.count(CutFlow::ThirdTrackPt, kinematics, i, j);
+
+            // reference point of third track must be close to the two-prong vertex
+            double trackvtxsepx = theThirdTrackSepX[m];
+            double trackvtxsepy = theThirdTrackSepY[m];
+            double trackvtxsepz = theThirdTrackSepZ[m];
+            if( trackvtxsepx>Decay::maxThirdTrackSep
+                || trackvtxsepy>Decay::maxThirdTrackSep
+                || trackvtxsepz>Decay::maxThirdTrackSep ) continue;
+            theCutFlow.count(CutFlow::ThirdTrackSep, kinematics, i, j);
+
+            // check if mass is close enough to the three-prong mass
+            if(std::abs(std::sqrt(std::max(theThreeTrackMass2[m], 0.))
+                        - Decay::threeProngMass) > Decay::threeProngMassWindow) continue;
+            theCutFlow.count(CutFlow::ThreeProngMass, kinematics, i, j);
+
+            // skip triplets that can not beat the kept candidates
+            if( ranking.enabled()
+                && theRankedCandidates.rejects(tripletScoreBound(ranking, pair, kinematics, k)) ){
+                ranking.countPrunedTriplet();
+                continue;
+            }
+
+            // add the triplet to the batch
+            theTriplets.push_back({p, k, trackvtxsepx, trackvtxsepy, trackvtxsepz});
+            theTripletTracks.push_back({pair.pair, i, j, k});
+        } // end loop over third track
+    } // end loop over pairs
+}
+
+// triplet vertex fits //
+template<class Decay>
+void ThreeProngChannel<Decay>::fitTriplets(CandidateVertexFitter& fitter,
+                                           TransientTrackCache& transientTracks){
+    // (note: depending on the configuration, this is either a full Kalman fit,
+    //  an incremental update of the two-track vertex with the third track,
+    //  or a fit with the lightweight vertex fitter)
+    fitter.fitTriplets(theTripletTracks, transientTracks, theTripletVertices);
+}
+
+template<class Decay>
+void ThreeProngChannel<Decay>::fitTriplet(unsigned t,
+                                          CandidateVertexFitter& fitter,
+                                          TransientTrackCache& transientTracks){
+    // (note: the vertices stay aligned with the triplets,
+    //  only the vertices of the triplets that were fitted are used)
+    if( theTripletVertices.size()<theTripletTracks.size() ) theTripletVertices.resize(theTripletTracks.size());
+    theTripletVertices[t] = fitter.fitTriplet(theTripletTracks[t], transientTracks);
+}
+
+// candidates //
+template<class Decay>
+void ThreeProngChannel<Decay>::collectCandidates(
+        const SelectedTracks& tracks,
+        const CandidateRanking& ranking,
+        unsigned maxCandidates,
+        std::vector<ThreeProngCandidate>& candidates){
+    for(unsigned t=0; t<theTriplets.size(); t++){
+        // stop in case maximum number was reached
+        // (note: not needed when ranking, the queue keeps only the best candidates)
+        if( !ranking.enabled() && candidates.size() >= maxCandidates ) break;
+        collectCandidate(tracks, ranking, t, candidates);
+    } // end loop over triplets
+}
+
+template<class Decay>
+void ThreeProngChannel<Decay>::collectCandidate(
+        const SelectedTracks& tracks,
+        const CandidateRanking& ranking,
+        unsigned t,
+        std::vector<ThreeProngCandidate>& candidates){
+    constexpr double thirdTrackMass = (Decay::thirdTrack==TrackKinematics::Pion) ?
+                                      TrackKinematics::pimass : TrackKinematics::kmass;
+    const TripletCandidate& triplet = theTriplets[t];
+    const TransientVertex& tripletvtx = theTripletVertices[t];
+
+    // vertex must be valid and chi squared of fit must be small
+    if(!tripletvtx.isValid()) return;
+    if(tripletvtx.normalisedChiSquared()>Decay::maxThreeProngNormChi2) return;
+    if(tripletvtx.normalisedChiSquared()<0.) return;
+
+    // make the candidate
+    const PairCandidate& pair = thePairs[triplet.pair];
+    theCutFlow.count(CutFlow::ThreeProngFit, tracks.kinematics(), pair.track1, pair.track2);
+    const reco::Track& tr3 = tracks.track(triplet.track3);
+    ROOT::Math::PtEtaPhiMVector track3P4(tr3.pt(), tr3.eta(), tr3.phi(), thirdTrackMass);
+    ThreeProngCandidate candidate{pair.track1, pair.track2, pair.posTrack, pair.negTrack,
+                                  pair.daughter1Track, pair.daughter2Track, triplet.track3,
+                                  pair.daughter1P4, pair.daughter2P4, pair.twoProngP4,
+                                  track3P4, pair.twoProngP4 + track3P4,
+                                  pair.sepx, pair.sepy, pair.sepz,
+                                  triplet.sepx, triplet.sepy, triplet.sepz,
+                                  pair.normChi2,
+                                  tripletvtx.normalisedChiSquared()};
+    if( ranking.enabled() ) theRankedCandidates.push(score(ranking, candidate), candidate);
+    else candidates.push_back(candidate);
+}
+
+// ranking scores //
+template<class Decay>
+double ThreeProngChannel<Decay>::score(const CandidateRanking& ranking,
+                                       const ThreeProngCandidate& candidate) const {
+    switch( ranking.score() ){
+        case CandidateRanking::NormChi2: return candidate.threeProngNormChi2;
+        case CandidateRanking::MassDiff: return std::abs(candidate.twoProngP4.M() - Decay::twoProngMass);
+        case CandidateRanking::Pt: return -candidate.threeProngP4.pt();
+        default: return 0.;
+    }
+}
+
+template<class Decay>
+double ThreeProngChannel<Decay>::pairScoreBound(const CandidateRanking& ranking,
+                                                const PairCandidate& pair) const {
+    switch( ranking.score() ){
+        // (note: adding a track to the vertex fit can not decrease the chi squared,
+        //  while the number of degrees of freedom goes from 1 to 3)
+        case CandidateRanking::NormChi2: return pair.normChi2/3.;
+        case CandidateRanking::MassDiff: return std::abs(pair.twoProngP4.M() - Decay::twoProngMass);
+        default: return -std::numeric_limits<double>::infinity();
+    }
+}
+
+template<class Decay>
+double ThreeProngChannel<Decay>::tripletScoreBound(const CandidateRanking& ranking,
+                                                   const PairCandidate& pair,
+                                                   const TrackKinematics& kinematics,
+                                                   unsigned track3) const {
+    if( ranking.score()==CandidateRanking::Pt ){
+        // (note: the transverse momentum does not depend on the vertex fit)
+        return -std::hypot(pair.twoProngP4.Px() + kinematics.px(track3),
+                           pair.twoProngP4.Py() + kinematics.py(track3));
+    }
+    return pairScoreBound(ranking, pair);
+}
+
+// explicit instantiations for the supported decay channels
+template class ThreeProngChannel<DStarDecay>;
+template class ThreeProngChannel<HToDStarDecay>;
+template class ThreeProngChannel<DsDecay>;
+template class ThreeProngChannel<HToDsDecay>;
@@ -0,0 +1,24 @@
+/*
+Per-event cache of transient tracks for the vertex fits in the charmed meson producers.
+*/
+
+// local include files
+#include "PhysicsTools/HcNano/interface/TransientTrackCache.h"
+
+void TransientTrackCache::reset(
+        const std::vector<const reco::Track*>& tracks,
+        const MagneticField* field){
+    theTracks = &tracks;
+    theField = field;
+    // (note: assign rather than clear and resize, so that the memory of the previous event is reused)
+    theTransientTracks.assign(tracks.size(), reco::TransientTrack());
+    theIsBuilt.assign(tracks.size(), false);
+}
+
+const reco::TransientTrack& TransientTrackCache::get(size_t i){
+    if( !theIsBuilt[i] ){
+        theTransientTracks[i] = reco::TransientTrack(*(*theTracks)[i], theField);
+        theIsBuilt[i] = true;
+    }
+    return theTransientTracks[i];
+}
@@ -0,0 +1,78 @@
+/*
+Custom analyzer class for finding two-prong candidates from pairs of tracks.
+*/
+
+// local include files
+#include "PhysicsTools/HcNano/interface/TwoProngCandidateProducer.h"
+
+// constructor //
+template<class Decay>
+TwoProngCandidateProducer<Decay>::TwoProngCandidateProducer(const edm::ParameterSet& iConfig)
+  : name(iConfig.getParameter<std::string>("name")),
+    finderConfig(iConfig),
+    selectedTracksToken(this->template consumes<SelectedTracks>(
+        iConfig.getParameter<edm::InputTag>("selectedTracksToken"))){
+    // declare products to be produced
+    this->template produces<TwoProngCandidateCollection>();
+}
+
+// destructor //
+template<class Decay>
+TwoProngCandidateProducer<Decay>::~TwoProngCandidateProducer(){}
+
+// beginning of stream //
+template<class Decay>
+std::unique_ptr<ThreeProngCandidateFinder<Decay>> TwoProngCandidateProducer<Decay>::beginStream(edm::StreamID) const {
+    return std::make_unique<ThreeProngCandidateFinder<Decay>>(finderConfig);
+}
+
+// end of stream //
+template<class Decay>
+void TwoProngCandidateProducer<Decay>::endStream(edm::StreamID id) const {
+    this->streamCache(id)->print(name);
+    std::lock_guard<std::mutex> lock(jobTimersMutex);
+    jobTimers.merge(this->streamCache(id)->timers());
+}
+
+// end of job //
+template<class Decay>
+void TwoProngCandidateProducer<Decay>::endJob(){
+    jobTimers.print(name);
+}
+
+// descriptions //
+template<class Decay>
+void TwoProngCandidateProducer<Decay>::fillDescriptions(edm::ConfigurationDescriptions &descriptions){
+    edm::ParameterSetDescription desc;
+    desc.add<std::string>("name", "Name for printouts");
+    ThreeProngCandidateFinder<Decay>::fillDescriptions(desc);
+    desc.add<edm::InputTag>("selectedTracksToken", edm::InputTag("selectedTracksToken"));
+    descriptions.addWithDefaultLabel(desc);
+}
+
+// produce (main method) //
+template<class Decay>
+void TwoProngCandidateProducer<Decay>::produce(edm::StreamID id, edm::Event& iEvent, const edm::EventSetup& iSetup) const {
+
+    // candidate finder of this stream
+    ThreeProngCandidateFinder<Decay>& candidateFinder = *this->streamCache(id);
+
+    // get all required objects from tokens
+    edm::Handle<SelectedTracks> selectedTracksHandle;
+    iEvent.getByToken(selectedTracksToken, selectedTracksHandle);
+
+    // find the two-prong candidates
+    std::array<std::vector<TwoProngCandidate>, 1> twoProngs;
+    candidateFinder.findTwoProngs(*selectedTracksHandle, iEvent.id(), twoProngs);
+    const EventBudget& budget = candidateFinder.budget();
+    candidateFinder.timers().finish(selectedTracksHandle->size(), budget.nPairs(), budget.nFits());
+
+    // add them to the output
+    iEvent.put(std::make_unique<TwoProngCandidateCollection>(std::move(twoProngs[0])));
+}
+
+// define the plug-ins
+typedef TwoProngCandidateProducer<DStarDecay> DZeroCandidateProducer;
+typedef TwoProngCandidateProducer<DsDecay> PhiCandidateProducer;
+DEFINE_FWK_MODULE(DZeroCandidateProducer);
+DEFINE_FWK_MODULE(PhiCandidateProducer);
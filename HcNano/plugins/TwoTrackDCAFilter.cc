@@ -0,0 +1,46 @@
+/*
+Fast analytic prefilter on the distance of closest approach between two tracks.
+*/
+
+// system include files
+#include <iostream>
+
+// local include files
+#include "PhysicsTools/HcNano/interface/TwoTrackDCAFilter.h"
+
+// closest approach include files
+#include "TrackingTools/PatternTools/interface/ClosestApproachInRPhi.h"
+
+// constructor //
+TwoTrackDCAFilter::TwoTrackDCAFilter(double maxDCA)
+  : theMaxDCA(maxDCA){}
+
+// filter //
+bool TwoTrackDCAFilter::passes(
+        const reco::TransientTrack& track1,
+        const reco::TransientTrack& track2){
+    if( theMaxDCA <= 0 ) return true;
+    theNTested++;
+    ClosestApproachInRPhi closestApproach;
+    closestApproach.calculate(track1.initialFreeState(), track2.initialFreeState());
+    if( !closestApproach.status() ){
+        theNFailed++;
+        return true;
+    }
+    if( closestApproach.distance() > theMaxDCA ){
+        theNRejected++;
+        return false;
+    }
+    return true;
+}
+
+// summary //
+void TwoTrackDCAFilter::print(const std::string& name) const {
+    if( theMaxDCA <= 0 ) return;
+    std::cout << "Two-track DCA prefilter for " << name;
+    std::cout << " (max. DCA: " << theMaxDCA << " cm):" << std::endl;
+    std::cout << "  tested pairs: " << theNTested << std::endl;
+    std::cout << "  rejected pairs (vertex fits saved): " << theNRejected << std::endl;
+    std::cout << "  pairs where the DCA could not be calculated: " << theNFailed << std::endl;
+    std::cout << "  vertex fits done: " << theNTested - theNRejected << std::endl;
+}
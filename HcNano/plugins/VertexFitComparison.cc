@@ -0,0 +1,63 @@
+/*
+Comparison of two vertex fits on a sample of candidates.
+*/
+
+// system include files
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// local include files
+#include "PhysicsTools/HcNano/interface/VertexFitComparison.h"
+
+// constructor //
+VertexFitComparison::VertexFitComparison(
+        const std::string& title,
+        unsigned interval,
+        double maxNormChi2)
+  : theTitle(title),
+    theInterval(interval),
+    theMaxNormChi2(maxNormChi2){}
+
+// comparison //
+bool VertexFitComparison::sample(){
+    if( theInterval==0 ) return false;
+    theNCandidates++;
+    return (theNCandidates % theInterval == 0);
+}
+
+bool VertexFitComparison::passes(const TransientVertex& vertex) const {
+    if( !vertex.isValid() ) return false;
+    double normChi2 = vertex.normalisedChiSquared();
+    return (normChi2 >= 0. && normChi2 <= theMaxNormChi2);
+}
+
+void VertexFitComparison::fill(
+        const TransientVertex& vertex,
+        const TransientVertex& reference){
+    theNCompared++;
+    if( passes(vertex) != passes(reference) ) theNDecisionMismatch++;
+    if( !vertex.isValid() || !reference.isValid() ) return;
+    theNBothValid++;
+    theSumDx += std::abs(vertex.position().x() - reference.position().x());
+    theSumDy += std::abs(vertex.position().y() - reference.position().y());
+    theSumDz += std::abs(vertex.position().z() - reference.position().z());
+    double dNormChi2 = std::abs(vertex.normalisedChiSquared() - reference.normalisedChiSquared());
+    theSumDNormChi2 += dNormChi2;
+    theMaxDNormChi2 = std::max(theMaxDNormChi2, dNormChi2);
+}
+
+// summary //
+void VertexFitComparison::print(const std::string& name) const {
+    if( theInterval==0 ) return;
+    std::cout << theTitle << " for " << name << ":" << std::endl;
+    std::cout << "  compared candidates: " << theNCompared;
+    std::cout << " (1 out of " << theInterval << ")" << std::endl;
+    std::cout << "  selection decision mismatches: " << theNDecisionMismatch << std::endl;
+    if( theNBothValid==0 ) return;
+    std::cout << "  mean |dx|, |dy|, |dz| (cm): " << theSumDx/theNBothValid;
+    std::cout << ", " << theSumDy/theNBothValid;
+    std::cout << ", " << theSumDz/theNBothValid << std::endl;
+    std::cout << "  mean |d(chi2/ndf)|: " << theSumDNormChi2/theNBothValid;
+    std::cout << " (max: " << theMaxDNormChi2 << ")" << std::endl;
+}
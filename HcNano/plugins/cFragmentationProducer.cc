@@ -9,8 +9,8 @@ Custom analyzer class for investigating c-quark fragmentation.
 // constructor //
 cFragmentationProducer::cFragmentationProducer(const edm::ParameterSet& iConfig)
   : name(iConfig.getParameter<std::string>("name")),
-    genParticlesToken(consumes<reco::GenParticleCollection>(
-        iConfig.getParameter<edm::InputTag>("genParticlesToken"))) {
+    genEventIndexToken(consumes<GenEventIndex>(
+        iConfig.getParameter<edm::InputTag>("genEventIndexToken"))) {
     // declare tables to be produced
     produces<nanoaod::FlatTable>(name);
 };
@@ -22,37 +22,32 @@ cFragmentationProducer::~cFragmentationProducer(){}
 void cFragmentationProducer::fillDescriptions(edm::ConfigurationDescriptions &descriptions){
     edm::ParameterSetDescription desc;
     desc.add<std::string>("name", "Name for output table");
-    desc.add<edm::InputTag>("genParticlesToken", edm::InputTag("genParticlesToken"));
+    desc.add<edm::InputTag>("genEventIndexToken", edm::InputTag("genEventIndexToken"));
     descriptions.addWithDefaultLabel(desc);
 }
 
 // produce (main method) //
 void cFragmentationProducer::produce(edm::Event& iEvent, const edm::EventSetup& iSetup){
 
-    // get gen particles
-    edm::Handle<std::vector<reco::GenParticle>> genParticles;
-    iEvent.getByToken(genParticlesToken, genParticles);
-    if(!genParticles.isValid()){
-        std::cout << "WARNING: genParticle collection not valid" << std::endl;
+    // get the index of the gen particles
+    edm::Handle<GenEventIndex> genEventIndex;
+    iEvent.getByToken(genEventIndexToken, genEventIndex);
+    if(!genEventIndex.isValid()){
+        std::cout << "WARNING: gen event index not valid" << std::endl;
         return;
     }
+    const std::vector<reco::GenParticle>& genParticles = genEventIndex->particles();
 
-    // find all gen particles from the hard scattering
-    // (implemented here as having a proton as their mother)
-    std::vector<const reco::GenParticle*> hardScatterParticles;
-    for( const reco::GenParticle& p : *genParticles ){
-        if( !p.isLastCopy() ) continue;
-        int mompdgid = GenTools::getMotherPdgId(p, *genParticles);
-        if( std::abs(mompdgid)!=2212 ) continue;
-        hardScatterParticles.push_back(&p);
-    }
+    // get all gen particles from the hard scattering
+    // (implemented as having a proton as their mother, see GenEventIndex)
+    const std::vector<unsigned>& hardScatterParticles = genEventIndex->hardScatter();
     if( hardScatterParticles.size() < 1 ) return;
 
     // find charmed hadrons
     int cFragmentationPdgId = 0;
     int cBarFragmentationPdgId = 0;
-    for( const reco::GenParticle* p : hardScatterParticles ){
-        int pdgid = p->pdgId();
+    for( unsigned idx : hardScatterParticles ){
+        int pdgid = genParticles[idx].pdgId();
         if( (std::abs(pdgid) > 400 && std::abs(pdgid) < 500)
             || (std::abs(pdgid) > 4000 && std::abs(pdgid) < 5000) ){
             if(pdgid > 0) cFragmentationPdgId = pdgid;
@@ -65,8 +60,8 @@ void cFragmentationProducer::produce(edm::Event& iEvent, const edm::EventSetup&
         std::cout << "WARNING in cFragmentationAnalyzer:";
         std::cout << " no c-meson and/or cbar-meson found." << std::endl;
         std::cout << "Pdgids of hard scattering particles are:" << std::endl;
-        for( const reco::GenParticle* p : hardScatterParticles ){
-            int pdgid = p->pdgId();
+        for( unsigned idx : hardScatterParticles ){
+            int pdgid = genParticles[idx].pdgId();
             std::cout << pdgid << " ";
         }
         std::cout << std::endl;
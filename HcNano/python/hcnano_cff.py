@@ -90,10 +90,92 @@ def add_trigger_selector(process, dtype='mc', year=None):
             process.schedule.append(process.genWeightsPath)
 
 
+def add_selected_track_producer(process, dtype='mc'):
+    # shared track preselection for all charmed meson producers.
+    # note: this producer is added only once,
+    #       no matter how many meson producers are consuming its output.
+    if hasattr(process, 'SelectedTrackProducer'): return
+    process.SelectedTrackProducer = cms.EDProducer("SelectedTrackProducer",
+        packedPFCandidatesToken = cms.InputTag("packedPFCandidates"),
+        lostTracksToken = cms.InputTag("lostTracks"),
+        minPt = cms.double(0.3),
+        quality = cms.string("highPurity"),
+        gridCellSize = cms.double(0.4),
+        gridEtaMax = cms.double(3.0)
+    )
+    process.nanoAOD_step = cms.Path(
+      process.nanoAOD_step._seq
+      * process.SelectedTrackProducer
+    )
+
+def add_gen_event_index_producer(process, dtype='mc'):
+    # shared index of the gen particles (mothers, daughters and hard scattering particles)
+    # for all gen-level producers and for the gen-matching of the meson producers.
+    # note: this producer is added only once,
+    #       no matter how many producers are consuming its output.
+    if hasattr(process, 'GenEventIndexProducer'): return
+    process.GenEventIndexProducer = cms.EDProducer("GenEventIndexProducer",
+        genParticlesToken = cms.InputTag("prunedGenParticles")
+    )
+    process.nanoAOD_step = cms.Path(
+      process.nanoAOD_step._seq
+      * process.GenEventIndexProducer
+    )
+
+def candidate_finder_settings(cut_flow=False, stage_timers=False):
+    # settings of the candidate finder (track pairing, vertex fitting, ranking and budgets),
+    # shared by all meson producers and two-prong candidate producers.
+    # note: the parameters of the returned PSet are added directly to the producer
+    #       when passed as a positional argument to cms.EDProducer.
+    return cms.PSet(
+        pairBatchSize = cms.uint32(32),
+        maxTwoTrackDCA = cms.double(0.),
+        vertexFitter = cms.string("kalman"),
+        vertexFitterComparisonInterval = cms.uint32(0),
+        incrementalTripletFit = cms.bool(False),
+        incrementalFitValidationInterval = cms.uint32(0),
+        candidateRanking = cms.string("first"),
+        parallelTrackThreshold = cms.uint32(0),
+        parallelChunks = cms.uint32(8),
+        maxPairsPerEvent = cms.uint32(0),
+        maxVertexFitsPerEvent = cms.uint32(0),
+        maxTimePerEvent = cms.double(0.),
+        cutFlow = cms.bool(cut_flow),
+        stageTimers = cms.bool(stage_timers)
+    )
+
+def add_two_prong_candidate_producer(process, modulename, dtype='mc'):
+    # shared two-prong candidates (track pairs with a good two-track vertex)
+    # for all meson producers of the corresponding decay.
+    # note: this producer is added only once,
+    #       no matter how many meson producers are consuming its output;
+    #       the candidates are only used as input and are not kept in the output.
+    if hasattr(process, modulename): return
+    add_selected_track_producer(process, dtype=dtype)
+    producer = cms.EDProducer(modulename,
+        candidate_finder_settings(),
+        name = cms.string(modulename),
+        selectedTracksToken = cms.InputTag("SelectedTrackProducer")
+    )
+    setattr(process, modulename, producer)
+    process.nanoAOD_step = cms.Path(
+      process.nanoAOD_step._seq
+      * producer
+    )
+
+def add_dzero_candidate_producer(process, dtype='mc'):
+    # D0 -> K pi candidates, with the (loosest) cuts of the D* producer
+    add_two_prong_candidate_producer(process, 'DZeroCandidateProducer', dtype=dtype)
+
+def add_phi_candidate_producer(process, dtype='mc'):
+    # phi -> K K candidates, with the (loosest) cuts of the Ds producer
+    add_two_prong_candidate_producer(process, 'PhiCandidateProducer', dtype=dtype)
+
 def add_ds_gen_producer(process, name='GenDsMeson', dtype='mc'):
+    add_gen_event_index_producer(process, dtype=dtype)
     process.DsMesonGenProducer = cms.EDProducer("DsMesonGenProducer",
         name = cms.string(name),
-        genParticlesToken = cms.InputTag("prunedGenParticles")
+        genEventIndexToken = cms.InputTag("GenEventIndexProducer")
     )
     process.nanoAOD_step = cms.Path(
       process.nanoAOD_step._seq
@@ -102,13 +184,21 @@ def add_ds_gen_producer(process, name='GenDsMeson', dtype='mc'):
     outputmodule = process.NANOAODSIMoutput if dtype=='mc' else process.NANOAODoutput
     outputmodule.outputCommands.append("keep *_DsMesonGenProducer_*_*")
 
-def add_ds_producer(process, name='DsMeson', dtype='mc'):
+def add_ds_producer(process, name='DsMeson', dtype='mc', use_two_prong_candidates=False, cut_flow=False, stage_timers=False):
+    add_selected_track_producer(process, dtype=dtype)
+    if dtype=='mc': add_gen_event_index_producer(process, dtype=dtype)
+    # optionally take the two-prong candidates from the shared producer
+    twoProngCandidatesToken = cms.InputTag("")
+    if use_two_prong_candidates:
+        add_phi_candidate_producer(process, dtype=dtype)
+        twoProngCandidatesToken = cms.InputTag("PhiCandidateProducer")
     process.DsMesonProducer = cms.EDProducer("DsMesonProducer",
+        candidate_finder_settings(cut_flow=cut_flow, stage_timers=stage_timers),
         name = cms.string(name),
         dtype = cms.string(dtype),
-        genParticlesToken = cms.InputTag("prunedGenParticles"),
-        packedPFCandidatesToken = cms.InputTag("packedPFCandidates"),
-        lostTracksToken = cms.InputTag("lostTracks")
+        genEventIndexToken = cms.InputTag("GenEventIndexProducer"),
+        selectedTracksToken = cms.InputTag("SelectedTrackProducer"),
+        twoProngCandidatesToken = twoProngCandidatesToken
     )
     process.nanoAOD_step = cms.Path(
       process.nanoAOD_step._seq
@@ -118,9 +208,10 @@ def add_ds_producer(process, name='DsMeson', dtype='mc'):
     outputmodule.outputCommands.append("keep *_DsMesonProducer_*_*")
 
 def add_dstar_gen_producer(process, name='GenDStarMeson', dtype='mc'):
+    add_gen_event_index_producer(process, dtype=dtype)
     process.DStarMesonGenProducer = cms.EDProducer("DStarMesonGenProducer",
         name = cms.string(name),
-        genParticlesToken = cms.InputTag("prunedGenParticles")
+        genEventIndexToken = cms.InputTag("GenEventIndexProducer")
     )
     process.nanoAOD_step = cms.Path(
       process.nanoAOD_step._seq
@@ -129,13 +220,21 @@ def add_dstar_gen_producer(process, name='GenDStarMeson', dtype='mc'):
     outputmodule = process.NANOAODSIMoutput if dtype=='mc' else process.NANOAODoutput
     outputmodule.outputCommands.append("keep *_DStarMesonGenProducer_*_*")
 
-def add_dstar_producer(process, name='DStarMeson', dtype='mc'):
+def add_dstar_producer(process, name='DStarMeson', dtype='mc', use_two_prong_candidates=False, cut_flow=False, stage_timers=False):
+    add_selected_track_producer(process, dtype=dtype)
+    if dtype=='mc': add_gen_event_index_producer(process, dtype=dtype)
+    # optionally take the two-prong candidates from the shared producer
+    twoProngCandidatesToken = cms.InputTag("")
+    if use_two_prong_candidates:
+        add_dzero_candidate_producer(process, dtype=dtype)
+        twoProngCandidatesToken = cms.InputTag("DZeroCandidateProducer")
     process.DStarMesonProducer = cms.EDProducer("DStarMesonProducer",
+        candidate_finder_settings(cut_flow=cut_flow, stage_timers=stage_timers),
         name = cms.string(name),
         dtype = cms.string(dtype),
-        genParticlesToken = cms.InputTag("prunedGenParticles"),
-        packedPFCandidatesToken = cms.InputTag("packedPFCandidates"),
-        lostTracksToken = cms.InputTag("lostTracks")
+        genEventIndexToken = cms.InputTag("GenEventIndexProducer"),
+        selectedTracksToken = cms.InputTag("SelectedTrackProducer"),
+        twoProngCandidatesToken = twoProngCandidatesToken
     )
     process.nanoAOD_step = cms.Path(
       process.nanoAOD_step._seq
@@ -145,9 +244,10 @@ def add_dstar_producer(process, name='DStarMeson', dtype='mc'):
     outputmodule.outputCommands.append("keep *_DStarMesonProducer_*_*")
 
 def add_dzero_gen_producer(process, name='GenDZeroMeson', dtype='mc'):
+    add_gen_event_index_producer(process, dtype=dtype)
     process.DZeroMesonGenProducer = cms.EDProducer("DZeroMesonGenProducer",
         name = cms.string(name),
-        genParticlesToken = cms.InputTag("prunedGenParticles")
+        genEventIndexToken = cms.InputTag("GenEventIndexProducer")
     )
     process.nanoAOD_step = cms.Path(
       process.nanoAOD_step._seq
@@ -157,9 +257,10 @@ def add_dzero_gen_producer(process, name='GenDZeroMeson', dtype='mc'):
     outputmodule.outputCommands.append("keep *_DZeroMesonGenProducer_*_*")
 
 def add_cfragmentation_producer(process, name='cFragmentation', dtype='mc'):
+    add_gen_event_index_producer(process, dtype=dtype)
     process.cFragmentationProducer = cms.EDProducer("cFragmentationProducer",
         name = cms.string(name),
-        genParticlesToken = cms.InputTag("prunedGenParticles")
+        genEventIndexToken = cms.InputTag("GenEventIndexProducer")
     )
     process.nanoAOD_step = cms.Path(
       process.nanoAOD_step._seq
@@ -169,9 +270,10 @@ def add_cfragmentation_producer(process, name='cFragmentation', dtype='mc'):
     outputmodule.outputCommands.append("keep *_cFragmentationProducer_*_*")
 
 def add_btodstar_gen_producer(process, name='GenBHadron', dtype='mc'):
+    add_gen_event_index_producer(process, dtype=dtype)
     process.BToDStarMesonGenProducer = cms.EDProducer("BToDStarMesonGenProducer",
         name = cms.string(name),
-        genParticlesToken = cms.InputTag("prunedGenParticles")
+        genEventIndexToken = cms.InputTag("GenEventIndexProducer")
     )
     process.nanoAOD_step = cms.Path(
       process.nanoAOD_step._seq
@@ -181,9 +283,10 @@ def add_btodstar_gen_producer(process, name='GenBHadron', dtype='mc'):
     outputmodule.outputCommands.append("keep *_BToDStarMesonGenProducer_*_*")
 
 def add_htodstar_gen_producer(process, name='GenHToDStarMeson', dtype='mc'):
+    add_gen_event_index_producer(process, dtype=dtype)
     process.HToDStarMesonGenProducer = cms.EDProducer("HToDStarMesonGenProducer",
         name = cms.string(name),
-        genParticlesToken = cms.InputTag("prunedGenParticles")
+        genEventIndexToken = cms.InputTag("GenEventIndexProducer")
     )
     process.nanoAOD_step = cms.Path(
       process.nanoAOD_step._seq
@@ -192,13 +295,21 @@ def add_htodstar_gen_producer(process, name='GenHToDStarMeson', dtype='mc'):
     outputmodule = process.NANOAODSIMoutput if dtype=='mc' else process.NANOAODoutput
     outputmodule.outputCommands.append("keep *_HToDStarMesonGenProducer_*_*")
 
-def add_htodstar_producer(process, name='HToDStarMeson', dtype='mc'):
+def add_htodstar_producer(process, name='HToDStarMeson', dtype='mc', use_two_prong_candidates=False, cut_flow=False, stage_timers=False):
+    add_selected_track_producer(process, dtype=dtype)
+    if dtype=='mc': add_gen_event_index_producer(process, dtype=dtype)
+    # optionally take the two-prong candidates from the shared producer
+    twoProngCandidatesToken = cms.InputTag("")
+    if use_two_prong_candidates:
+        add_dzero_candidate_producer(process, dtype=dtype)
+        twoProngCandidatesToken = cms.InputTag("DZeroCandidateProducer")
     process.HToDStarMesonProducer = cms.EDProducer("HToDStarMesonProducer",
+        candidate_finder_settings(cut_flow=cut_flow, stage_timers=stage_timers),
         name = cms.string(name),
         dtype = cms.string(dtype),
-        genParticlesToken = cms.InputTag("prunedGenParticles"),
-        packedPFCandidatesToken = cms.InputTag("packedPFCandidates"),
-        lostTracksToken = cms.InputTag("lostTracks")
+        genEventIndexToken = cms.InputTag("GenEventIndexProducer"),
+        selectedTracksToken = cms.InputTag("SelectedTrackProducer"),
+        twoProngCandidatesToken = twoProngCandidatesToken
     )
     process.nanoAOD_step = cms.Path(
       process.nanoAOD_step._seq
@@ -208,9 +319,10 @@ def add_htodstar_producer(process, name='HToDStarMeson', dtype='mc'):
     outputmodule.outputCommands.append("keep *_HToDStarMesonProducer_*_*")
 
 def add_htods_gen_producer(process, name='GenHToDsMeson', dtype='mc'):
+    add_gen_event_index_producer(process, dtype=dtype)
     process.HToDsMesonGenProducer = cms.EDProducer("HToDsMesonGenProducer",
         name = cms.string(name),
-        genParticlesToken = cms.InputTag("prunedGenParticles")
+        genEventIndexToken = cms.InputTag("GenEventIndexProducer")
     )
     process.nanoAOD_step = cms.Path(
       process.nanoAOD_step._seq
@@ -219,13 +331,21 @@ def add_htods_gen_producer(process, name='GenHToDsMeson', dtype='mc'):
     outputmodule = process.NANOAODSIMoutput if dtype=='mc' else process.NANOAODoutput
     outputmodule.outputCommands.append("keep *_HToDsMesonGenProducer_*_*")
 
-def add_htods_producer(process, name='HToDsMeson', dtype='mc'):
+def add_htods_producer(process, name='HToDsMeson', dtype='mc', use_two_prong_candidates=False, cut_flow=False, stage_timers=False):
+    add_selected_track_producer(process, dtype=dtype)
+    if dtype=='mc': add_gen_event_index_producer(process, dtype=dtype)
+    # optionally take the two-prong candidates from the shared producer
+    twoProngCandidatesToken = cms.InputTag("")
+    if use_two_prong_candidates:
+        add_phi_candidate_producer(process, dtype=dtype)
+        twoProngCandidatesToken = cms.InputTag("PhiCandidateProducer")
     process.HToDsMesonProducer = cms.EDProducer("HToDsMesonProducer",
+        candidate_finder_settings(cut_flow=cut_flow, stage_timers=stage_timers),
         name = cms.string(name),
         dtype = cms.string(dtype),
-        genParticlesToken = cms.InputTag("prunedGenParticles"),
-        packedPFCandidatesToken = cms.InputTag("packedPFCandidates"),
-        lostTracksToken = cms.InputTag("lostTracks")
+        genEventIndexToken = cms.InputTag("GenEventIndexProducer"),
+        selectedTracksToken = cms.InputTag("SelectedTrackProducer"),
+        twoProngCandidatesToken = twoProngCandidatesToken
     )
     process.nanoAOD_step = cms.Path(
       process.nanoAOD_step._seq
@@ -234,20 +354,33 @@ def add_htods_producer(process, name='HToDsMeson', dtype='mc'):
     outputmodule = process.NANOAODSIMoutput if dtype=='mc' else process.NANOAODoutput
     outputmodule.outputCommands.append("keep *_HToDsMesonProducer_*_*")
 
-def add_debugger(process, name='Dbugger', dtype='mc'):
-    process.Dbugger = cms.EDProducer("Dbugger",
-        name = cms.string(name),
+def add_multichannel_producer(process, modulename, names, dtype='mc', cut_flow=False, stage_timers=False):
+    # single-pass producer for several decay channels at once,
+    # sharing the loop over track pairs and the two-track vertex fits.
+    # note: makes the same output tables as the corresponding single-channel producers,
+    #       and should not be combined with them for the same channels.
+    add_selected_track_producer(process, dtype=dtype)
+    if dtype=='mc': add_gen_event_index_producer(process, dtype=dtype)
+    producer = cms.EDProducer(modulename,
+        candidate_finder_settings(cut_flow=cut_flow, stage_timers=stage_timers),
+        names = cms.vstring(*names),
         dtype = cms.string(dtype),
-        genParticlesToken = cms.InputTag("prunedGenParticles"),
-        packedPFCandidatesToken = cms.InputTag("packedPFCandidates"),
-        lostTracksToken = cms.InputTag("lostTracks")
+        genEventIndexToken = cms.InputTag("GenEventIndexProducer"),
+        selectedTracksToken = cms.InputTag("SelectedTrackProducer")
     )
+    setattr(process, modulename, producer)
     process.nanoAOD_step = cms.Path(
       process.nanoAOD_step._seq
-      * process.Dbugger
+      * producer
     )
     outputmodule = process.NANOAODSIMoutput if dtype=='mc' else process.NANOAODoutput
-    outputmodule.outputCommands.append("keep *_Dbugger_*_*")
+    outputmodule.outputCommands.append("keep *_{}_*_*".format(modulename))
+
+def add_dstar_ds_producer(process, names=('DStarMeson', 'DsMeson'), dtype='mc', cut_flow=False, stage_timers=False):
+    add_multichannel_producer(process, 'DStarDsMesonProducer', names, dtype=dtype, cut_flow=cut_flow, stage_timers=stage_timers)
+
+def add_htodstar_htods_producer(process, names=('HToDStarMeson', 'HToDsMeson'), dtype='mc', cut_flow=False, stage_timers=False):
+    add_multichannel_producer(process, 'HToDStarDsMesonProducer', names, dtype=dtype, cut_flow=cut_flow, stage_timers=stage_timers)
 
 
 def hcnano_customize(process):
@@ -273,6 +406,9 @@ def hcnano_customize(process):
     # disable IMT
     # (not sure what this does exactly, but recommended here:
     # https://gitlab.cern.ch/cms-nanoAOD/nanoaod-doc/-/wikis/Instructions/Private%20production)
+    # note: this only disables the implicit multithreading inside ROOT,
+    #       the framework can still run several threads and streams
+    #       (set with --nThreads and --nStreams in cmsDriver, see run/cmsrun.py).
     process.add_(cms.Service("InitRootHandlers", EnableIMT=cms.untracked.bool(False)))
 
     # set report frequency
@@ -300,11 +436,13 @@ def hcnano_customize(process):
         add_htods_gen_producer(process, dtype=dtype) # temp for investigating alternative signal
     #add_ds_producer(process, dtype=dtype)
     #add_dstar_producer(process, dtype=dtype)
-    add_htodstar_producer(process, dtype=dtype) # temp for investigating alternative signal
-    add_htods_producer(process, dtype=dtype) # temp for investigating alternative signal
-    
-    # temp: add debugger
-    #add_debugger(process, dtype=dtype)
+    #add_dstar_ds_producer(process, dtype=dtype) # same as the two above in a single pass
+    #add_htodstar_producer(process, dtype=dtype)
+    #add_htods_producer(process, dtype=dtype)
+    #add_htodstar_producer(process, dtype=dtype, use_two_prong_candidates=True) # D0 candidates shared with the D* producer
+    #add_ds_producer(process, dtype=dtype, cut_flow=True) # with cut-flow counters per luminosity block
+    #add_ds_producer(process, dtype=dtype, stage_timers=True) # with per-event cost columns and a timing summary
+    add_htodstar_htods_producer(process, dtype=dtype) # temp for investigating alternative signal
 
     # remove unneeded output
     # note: can give errors if the main table for a given object is dropped
@@ -0,0 +1,101 @@
+import os
+import sys
+import time
+import argparse
+import subprocess
+
+thisdir = os.path.dirname(os.path.abspath(__file__))
+topdir = os.path.abspath(os.path.join(thisdir, '../'))
+sys.path.append(topdir)
+
+from run.cmsdriver.cmsdriver import make_nano_cmsdriver
+from run.globaltags.globaltag import get_globaltag
+
+
+def run_benchmark(inputfile, nentries, nthreads, nstreams=None, workdir='.', **kwargs):
+    # make the cmsRun config for a given number of threads and streams
+    tag = f'benchmark_t{nthreads}_s{nstreams if nstreams is not None else nthreads}'
+    configname = os.path.join(workdir, f'{tag}.py')
+    outputfile = os.path.join(workdir, f'{tag}.root')
+    logfile = os.path.join(workdir, f'{tag}.log')
+    cmd = make_nano_cmsdriver(inputfile,
+            configname=configname, nentries=nentries, outputfile=outputfile,
+            no_exec=True, nthreads=nthreads, nstreams=nstreams, timing_summary=True, **kwargs)
+    os.system(cmd)
+
+    # run it and measure the wall time of the whole job
+    start = time.time()
+    with open(logfile, 'w') as f:
+        returncode = subprocess.call(['cmsRun', configname], stdout=f, stderr=subprocess.STDOUT)
+    walltime = time.time() - start
+    if returncode!=0: print(f'WARNING: cmsRun failed for {tag}, see {logfile}.')
+    return (walltime, read_throughput(logfile))
+
+
+def read_throughput(logfile):
+    # read the event loop throughput (in events per second) from the summary of the Timing service
+    # note: unlike the wall time of the whole job, this excludes the start-up of cmsRun
+    #       (config parsing, EventSetup and opening the input file).
+    with open(logfile, 'r') as f:
+        for line in f:
+            if 'Event Throughput:' in line:
+                return float(line.split(':')[1].split()[0])
+    print(f'WARNING: no event throughput found in {logfile}.')
+    return None
+
+
+if __name__=='__main__':
+
+    # read command line arguments
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-i', '--inputfile', required=True)
+    parser.add_argument('-n', '--nentries', default=1000, type=int)
+    parser.add_argument('-w', '--workdir', default='benchmark')
+    parser.add_argument('--nthreads', default=[1, 2, 4, 8], type=int, nargs='+')
+    parser.add_argument('--nstreams', default=None, type=int,
+      help='Number of streams (default: equal to the number of threads).')
+    parser.add_argument('--dtype', default=None)
+    parser.add_argument('--era', default=None)
+    parser.add_argument('--globaltag', default=None)
+    parser.add_argument('--year', default=None)
+    args = parser.parse_args()
+
+    # parse input file
+    if args.inputfile.startswith('root://'):
+        inputfile = args.inputfile
+    elif args.inputfile.startswith('/store/'):
+        inputfile = f'root://cms-xrd-global.cern.ch//{args.inputfile}'
+    else:
+        inputfile = os.path.abspath(args.inputfile)
+        inputfile = f'file:{inputfile}'
+
+    # parse global tag and era
+    globaltag = args.globaltag
+    if globaltag is not None and globaltag.endswith('.json'):
+        globaltag = get_globaltag(args.globaltag, year=args.year, dtype=args.dtype)['globaltag']
+    era = args.era
+    if era is not None and era.endswith('.json'):
+        era = get_globaltag(args.era, year=args.year, dtype=args.dtype)['era']
+
+    # run the benchmark for all thread counts
+    if not os.path.exists(args.workdir): os.makedirs(args.workdir)
+    results = []
+    for nthreads in args.nthreads:
+        walltime, throughput = run_benchmark(inputfile, args.nentries, nthreads, nstreams=args.nstreams,
+                     workdir=args.workdir,
+                     conditions=globaltag, era=era, dtype=args.dtype, year=args.year)
+        results.append((nthreads, walltime, throughput))
+
+    # print the results
+    # note: the events per second and the speed-up are those of the event loop,
+    #       the wall time is the one of the whole job (for reference).
+    print('Benchmark results ({} events):'.format(args.nentries))
+    print('  threads  wall time (s)  events/s  speed-up')
+    reference = results[0][2]
+    for nthreads, walltime, throughput in results:
+        if throughput is None:
+            print('  {:7d}  {:13.1f}  {:>8s}  {:>8s}'.format(nthreads, walltime, '-', '-'))
+            continue
+        speedup = throughput/reference if reference else float('nan')
+        print('  {:7d}  {:13.1f}  {:8.2f}  {:8.2f}'.format(
+          nthreads, walltime, throughput, speedup))
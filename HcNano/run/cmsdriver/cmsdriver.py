@@ -15,7 +15,10 @@ def make_nano_cmsdriver(inputfile,
         era = None,
         dtype = None,
         no_exec = False,
-        year = None):
+        year = None,
+        nthreads = None,
+        nstreams = None,
+        timing_summary = False):
 
     # check dtype
     if dtype is None:
@@ -34,6 +37,10 @@ def make_nano_cmsdriver(inputfile,
     if dtype=='mc': cmd += ' --eventcontent NANOAODSIM --datatier NANOAODSIM'
     else: cmd += ' --eventcontent NANOAOD --datatier NANOAOD'
     if no_exec: cmd += ' --no_exec'
+    # note: the charmed meson producers are global modules (or have one
+    #       candidate finder per stream), so they can run with several threads/streams.
+    if nthreads is not None: cmd += f' --nThreads {nthreads}'
+    if nstreams is not None: cmd += f' --nStreams {nstreams}'
     cmd += f' --filein {inputfile}'
     cmd += f' --fileout {outputfile}'
     cmd += f' -n {nentries}'
@@ -46,6 +53,10 @@ def make_nano_cmsdriver(inputfile,
     if year is not None: customize_commands.append(f'process.__dict__[\'year\'] = \'{year}\'')
     customize_commands.append('from PhysicsTools.HcNano.hcnano_cff import hcnano_customize')
     customize_commands.append('process = hcnano_customize(process)')
+    # note: the Timing service prints a summary at the end of the job,
+    #       including the throughput of the event loop (e.g. for benchmarking).
+    if timing_summary:
+        customize_commands.append('process.Timing = cms.Service(\'Timing\', summaryOnly = cms.untracked.bool(True))')
     cmd += ' --customise_commands="{}"'.format('; '.join(customize_commands))
 
     # return the cmsDriver command
@@ -23,6 +23,8 @@ if __name__=='__main__':
     parser.add_argument('--globaltag', default=None)
     parser.add_argument('--year', default=None)
     parser.add_argument('--no_exec', default=False, action='store_true')
+    parser.add_argument('--nthreads', default=None, type=int)
+    parser.add_argument('--nstreams', default=None, type=int)
     args = parser.parse_args()
 
     # parse input file
@@ -58,7 +60,8 @@ if __name__=='__main__':
             configname=args.configname,
             nentries=args.nentries, outputfile=args.outputfile,
             conditions=globaltag, era=era, dtype=args.dtype,
-            no_exec=args.no_exec, year=args.year)
+            no_exec=args.no_exec, year=args.year,
+            nthreads=args.nthreads, nstreams=args.nstreams)
 
     # run the cmsDriver command
     print(cmd)
@@ -0,0 +1,99 @@
+/*
+Binned eta-phi grid for fast spatial lookup of tracks.
+*/
+
+// system include files
+#include <algorithm>
+#include <cmath>
+
+// local include files
+#include "PhysicsTools/HcNano/interface/EtaPhiGrid.h"
+
+// constructor //
+EtaPhiGrid::EtaPhiGrid(
+        const std::vector<double>& etas,
+        const std::vector<double>& phis,
+        double cellSize,
+        double etaMax)
+  : theEtaMax(etaMax){
+
+    // define the cells
+    // (note: the number of cells is rounded down,
+    //  so the actual cells are at least as large as the requested cell size)
+    theNEta = std::max(1, static_cast<int>(std::floor(2*theEtaMax/cellSize)));
+    theNPhi = std::max(1, static_cast<int>(std::floor(2*M_PI/cellSize)));
+    theEtaWidth = 2*theEtaMax/theNEta;
+    thePhiWidth = 2*M_PI/theNPhi;
+
+    // count the number of objects per cell
+    std::vector<unsigned> cells(etas.size());
+    theCellOffsets.assign(nCells()+1, 0);
+    for(unsigned idx=0; idx < etas.size(); idx++){
+        cells[idx] = etaBin(etas[idx])*theNPhi + phiBin(phis[idx]);
+        theCellOffsets[cells[idx]+1]++;
+    }
+    for(unsigned cell=0; cell < nCells(); cell++){
+        theCellOffsets[cell+1] += theCellOffsets[cell];
+    }
+
+    // sort the objects per cell
+    // (note: within a cell, the objects remain ordered by index)
+    theIndices.resize(etas.size());
+    std::vector<unsigned> fill(theCellOffsets.begin(), theCellOffsets.end()-1);
+    for(unsigned idx=0; idx < etas.size(); idx++){
+        theIndices[fill[cells[idx]]++] = idx;
+    }
+}
+
+// helper functions //
+int EtaPhiGrid::etaBin(double eta) const {
+    int bin = static_cast<int>(std::floor((eta + theEtaMax)/theEtaWidth));
+    return std::clamp(bin, 0, static_cast<int>(theNEta)-1);
+}
+
+int EtaPhiGrid::phiBin(double phi) const {
+    int bin = static_cast<int>(std::floor((phi + M_PI)/thePhiWidth));
+    bin = bin % static_cast<int>(theNPhi);
+    if(bin < 0) bin += theNPhi;
+    return bin;
+}
+
+// query //
+void EtaPhiGrid::neighbours(
+        double eta, double phi, double deltaR,
+        std::vector<unsigned>& result,
+        unsigned minIndex) const {
+    result.clear();
+    if(theIndices.empty()) return;
+
+    // find the range of cells in eta
+    // (note: objects within deltaR are also within deltaR in eta alone)
+    int etaLow = etaBin(eta - deltaR);
+    int etaHigh = etaBin(eta + deltaR);
+
+    // find the range of cells in phi, taking into account the wraparound
+    // (note: if the range covers the full circle, each phi cell is visited only once)
+    int phiCenter = phiBin(phi);
+    int phiSpan = static_cast<int>(std::ceil(deltaR/thePhiWidth));
+    int nPhi = static_cast<int>(theNPhi);
+    int phiLow = phiCenter - phiSpan;
+    int phiHigh = phiCenter + phiSpan;
+    if(2*phiSpan+1 >= nPhi){
+        phiLow = 0;
+        phiHigh = nPhi-1;
+    }
+
+    // collect the objects in all those cells
+    for(int etaIdx=etaLow; etaIdx <= etaHigh; etaIdx++){
+        for(int phiIdx=phiLow; phiIdx <= phiHigh; phiIdx++){
+            int wrapped = ((phiIdx % nPhi) + nPhi) % nPhi;
+            unsigned cell = etaIdx*theNPhi + wrapped;
+            for(unsigned pos=theCellOffsets[cell]; pos < theCellOffsets[cell+1]; pos++){
+                if(theIndices[pos] >= minIndex) result.push_back(theIndices[pos]);
+            }
+        }
+    }
+
+    // sort by index
+    std::sort(result.begin(), result.end());
+}
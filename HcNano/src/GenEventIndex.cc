@@ -0,0 +1,59 @@
+/*
+Event product holding an index of the gen particle record.
+*/
+
+// local include files
+#include "PhysicsTools/HcNano/interface/GenEventIndex.h"
+
+// constructor //
+GenEventIndex::GenEventIndex(const std::vector<reco::GenParticle>& particles)
+  : theParticles(&particles){
+    const size_t n = particles.size();
+    theLastCopy.resize(n);
+    theMotherIndices.assign(n, -2);
+    theMotherPdgIds.assign(n, 0);
+    theDaughterOffsets.assign(n+1, 0);
+
+    // find the mother of each particle
+    // (note: copies of a particle are skipped, i.e. the mother of a particle
+    //  is the mother of its first mother if that one has the same pdg id.
+    //  the mothers are resolved once and remembered for all particles along a chain of copies,
+    //  so each particle is visited only once, whatever the order of the record;
+    //  -2 marks particles that are not resolved yet)
+    std::vector<unsigned> copies;
+    for(unsigned idx=0; idx < n; idx++){
+        int mother = -1;
+        unsigned current = idx;
+        copies.clear();
+        while( true ){
+            if( theMotherIndices[current]!=-2 ){
+                mother = theMotherIndices[current];
+                break;
+            }
+            copies.push_back(current);
+            const reco::GenParticle& p = particles[current];
+            if( p.numberOfMothers()==0 ) break;
+            unsigned firstMother = p.motherRef(0).key();
+            if( particles[firstMother].pdgId()!=p.pdgId() ){
+                mother = firstMother;
+                break;
+            }
+            current = firstMother;
+        }
+        for(unsigned copy : copies) theMotherIndices[copy] = mother;
+    }
+
+    // fill the remaining properties of each particle
+    for(unsigned idx=0; idx < n; idx++){
+        const reco::GenParticle& p = particles[idx];
+        theLastCopy[idx] = p.isLastCopy();
+        if( theMotherIndices[idx]>=0 ) theMotherPdgIds[idx] = particles[theMotherIndices[idx]].pdgId();
+        for(unsigned i=0; i < p.numberOfDaughters(); i++){
+            theDaughters.push_back(p.daughterRef(i).key());
+        }
+        theDaughterOffsets[idx+1] = theDaughters.size();
+        if( !theLastCopy[idx] ) continue;
+        theLastCopies.push_back(idx);
+        if( isHardScatter(idx) ) theHardScatter.push_back(idx);
+    }
+}
@@ -0,0 +1,106 @@
+/*
+Structure-of-arrays cache of track kinematics for the charmed meson producers.
+*/
+
+// system include files
+#include <cmath>
+
+// local include files
+#include "PhysicsTools/HcNano/interface/TrackKinematics.h"
+
+// fill //
+void TrackKinematics::push_back(const reco::Track& track){
+    double p2 = track.p()*track.p();
+    thePx.push_back(track.px());
+    thePy.push_back(track.py());
+    thePz.push_back(track.pz());
+    thePt.push_back(track.pt());
+    theEta.push_back(track.eta());
+    thePhi.push_back(track.phi());
+    theCharge.push_back(track.charge());
+    theVx.push_back(track.referencePoint().x());
+    theVy.push_back(track.referencePoint().y());
+    theVz.push_back(track.referencePoint().z());
+    theEPi.push_back(std::sqrt(p2 + pimass*pimass));
+    theEK.push_back(std::sqrt(p2 + kmass*kmass));
+}
+
+void TrackKinematics::reserve(size_t n){
+    thePx.reserve(n);
+    thePy.reserve(n);
+    thePz.reserve(n);
+    thePt.reserve(n);
+    theEta.reserve(n);
+    thePhi.reserve(n);
+    theCharge.reserve(n);
+    theVx.reserve(n);
+    theVy.reserve(n);
+    theVz.reserve(n);
+    theEPi.reserve(n);
+    theEK.reserve(n);
+}
+
+// kernels //
+void TrackKinematics::deltaR2(
+        double eta, double phi,
+        const std::vector<unsigned>& block,
+        std::vector<double>& out) const {
+    const size_t n = block.size();
+    out.resize(n);
+    const unsigned* __restrict idx = block.data();
+    const double* __restrict etas = theEta.data();
+    const double* __restrict phis = thePhi.data();
+    double* __restrict res = out.data();
+    for(size_t k=0; k < n; k++){
+        double deta = etas[idx[k]] - eta;
+        double dphi = std::abs(phis[idx[k]] - phi);
+        dphi = (dphi > M_PI) ? 2*M_PI - dphi : dphi;
+        res[k] = deta*deta + dphi*dphi;
+    }
+}
+
+void TrackKinematics::separation(
+        double x, double y, double z,
+        const std::vector<unsigned>& block,
+        std::vector<double>& outx,
+        std::vector<double>& outy,
+        std::vector<double>& outz) const {
+    const size_t n = block.size();
+    outx.resize(n);
+    outy.resize(n);
+    outz.resize(n);
+    const unsigned* __restrict idx = block.data();
+    const double* __restrict vxs = theVx.data();
+    const double* __restrict vys = theVy.data();
+    const double* __restrict vzs = theVz.data();
+    double* __restrict resx = outx.data();
+    double* __restrict resy = outy.data();
+    double* __restrict resz = outz.data();
+    for(size_t k=0; k < n; k++){
+        resx[k] = std::abs(vxs[idx[k]] - x);
+        resy[k] = std::abs(vys[idx[k]] - y);
+        resz[k] = std::abs(vzs[idx[k]] - z);
+    }
+}
+
+void TrackKinematics::mass2(
+        double e, double px, double py, double pz,
+        MassHypothesis hyp,
+        const std::vector<unsigned>& block,
+        std::vector<double>& out) const {
+    const size_t n = block.size();
+    out.resize(n);
+    const unsigned* __restrict idx = block.data();
+    const double* __restrict es = (hyp==Pion) ? theEPi.data() : theEK.data();
+    const double* __restrict pxs = thePx.data();
+    const double* __restrict pys = thePy.data();
+    const double* __restrict pzs = thePz.data();
+    double* __restrict res = out.data();
+    for(size_t k=0; k < n; k++){
+        double etot = e + es[idx[k]];
+        double pxtot = px + pxs[idx[k]];
+        double pytot = py + pys[idx[k]];
+        double pztot = pz + pzs[idx[k]];
+        res[k] = etot*etot - pxtot*pxtot - pytot*pytot - pztot*pztot;
+    }
+}
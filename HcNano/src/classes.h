@@ -0,0 +1,8 @@
+/*
+Dictionary includes for the event products defined in this package.
+*/
+
+#include "DataFormats/Common/interface/Wrapper.h"
+#include "PhysicsTools/HcNano/interface/SelectedTracks.h"
+#include "PhysicsTools/HcNano/interface/GenEventIndex.h"
+#include "PhysicsTools/HcNano/interface/TwoProngCandidate.h"